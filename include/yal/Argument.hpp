@@ -0,0 +1,131 @@
+//
+// Copyright (c) 2022 Alexander Mohr
+// Licensed under the terms of the MIT License
+//
+
+#ifndef YAL_ARGUMENT_HPP
+#define YAL_ARGUMENT_HPP
+
+#include <yal/Formatter.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace yal {
+
+/**
+ * Type erased argument of a log call.
+ * Call sites only build an array of arguments, the format string is rendered
+ * by a single non template function, which keeps the code per call site small.
+ * Like Field an argument only references its value for the duration of the call.
+ */
+class Argument {
+ public:
+  enum class Type : std::uint8_t { BOOL, CHAR, INT, UINT, DOUBLE, STRING, CUSTOM };
+
+  template<typename T>
+  // NOLINTNEXTLINE(google-explicit-constructor)
+  Argument(const T& value) {
+    using Value = std::decay_t<T>;
+    if constexpr (std::is_same_v<Value, bool>) {
+      m_type = Type::BOOL;
+      m_value.b = value;
+    } else if constexpr (
+      std::is_same_v<Value, char> || std::is_same_v<Value, signed char>
+      || std::is_same_v<Value, unsigned char>)
+    {
+      m_type = Type::CHAR;
+      m_value.c = static_cast<char>(value);
+    } else if constexpr (std::is_integral_v<Value> && std::is_signed_v<Value>) {
+      m_type = Type::INT;
+      m_value.i = value;
+    } else if constexpr (std::is_integral_v<Value>) {
+      m_type = Type::UINT;
+      m_value.u = value;
+    } else if constexpr (std::is_floating_point_v<Value>) {
+      m_type = Type::DOUBLE;
+      m_value.d = static_cast<double>(value);
+    } else if constexpr (
+      std::is_same_v<Value, const char*> || std::is_same_v<Value, char*>)
+    {
+      m_type = Type::STRING;
+      const std::string_view text = value == nullptr ? "" : value;
+      m_value.s = {text.data(), text.size()};
+    } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+      m_type = Type::STRING;
+      const std::string_view text(value);
+      m_value.s = {text.data(), text.size()};
+    } else {
+      // one writer per type instead of one per call site
+      m_type = Type::CUSTOM;
+      m_value.custom = {&value, &writeCustom<T>};
+    }
+  }
+
+  /**
+   * Append the value formatted like Formatter::write
+   */
+  void write(std::string& out) const;
+
+  [[nodiscard]] Type type() const {
+    return m_type;
+  }
+
+ private:
+  using Writer = void (*)(std::string& out, const void* value);
+
+  template<typename T>
+  static void writeCustom(std::string& out, const void* value) {
+    Formatter::write(out, *static_cast<const T*>(value));
+  }
+
+  Type m_type;
+  union {
+    bool b;
+    char c;
+    std::int64_t i;
+    std::uint64_t u;
+    double d;
+    struct {
+      const char* data;
+      std::size_t size;
+    } s;
+    struct {
+      const void* value;
+      Writer write;
+    } custom;
+  } m_value{};
+};
+
+/**
+ * Non owning view of the arguments of a log call
+ */
+class Arguments {
+ public:
+  Arguments() = default;
+
+  Arguments(const Argument* data, std::size_t size) : m_data(data), m_size(size) {
+  }
+
+  [[nodiscard]] const Argument* begin() const {
+    return m_data;
+  }
+
+  [[nodiscard]] const Argument* end() const {
+    return m_data + m_size;
+  }
+
+  [[nodiscard]] std::size_t size() const {
+    return m_size;
+  }
+
+ private:
+  const Argument* m_data = nullptr;
+  std::size_t m_size = 0;
+};
+
+}  // namespace yal
+
+#endif  // YAL_ARGUMENT_HPP
@@ -0,0 +1,98 @@
+//
+// Copyright (c) 2022 Alexander Mohr
+// Licensed under the terms of the MIT License
+//
+
+#ifndef YAL_COMPRESSOR_HPP
+#define YAL_COMPRESSOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#ifndef YAL_COMPRESSION_WINDOW_BITS
+// the compressor allocates 2^bits bytes once, longer windows find more matches
+#define YAL_COMPRESSION_WINDOW_BITS 10
+#endif
+
+namespace yal {
+
+/**
+ * Streaming LZSS compressor with a fixed RAM budget: the window, a copy of
+ * the dictionary of at most the window size and a hash chain index over the window
+ * of 2 bytes per window byte and hash bucket.
+ * Matches are only searched along a bounded chain of earlier positions
+ * starting with the same 3 bytes, which bounds the cost per byte.
+ * Each payload starts from a window primed with a dictionary,
+ * so short payloads already find matches and every payload decompresses on its own.
+ *
+ * Payload layout: u8 window bits, then groups of a flag byte and 8 tokens.
+ * A set flag bit (LSB first) marks a literal byte, a cleared one a match
+ * of 2 bytes big endian: (offset - 1) << length bits | (length - 3).
+ */
+class Compressor {
+ public:
+  static constexpr const unsigned WINDOW_BITS = YAL_COMPRESSION_WINDOW_BITS;
+
+  explicit Compressor(std::string_view dictionary = {});
+
+  /**
+   * Start a new payload in out, which has to be passed to all following writes
+   */
+  void begin(std::string& out);
+
+  /**
+   * Compress data and append the result to out.
+   * Matches do not span writes, so larger writes compress slightly better.
+   */
+  void write(std::string& out, const char* data, std::size_t size);
+
+  /**
+   * Decompress a payload created with the same dictionary and append it to out
+   * @return false if the payload is corrupt
+   */
+  static bool decompress(
+    std::string_view payload,
+    std::string_view dictionary,
+    std::string& out);
+
+  /**
+   * Dictionary of the text prefix format renders for every level and context,
+   * i.e. "[00000000000000000000][INFO ][default] "
+   */
+  static std::string dictionary(
+    const std::string& format,
+    std::initializer_list<std::string_view> contexts);
+
+ private:
+  static constexpr const std::size_t WINDOW_SIZE = std::size_t{1} << WINDOW_BITS;
+  static constexpr const unsigned HASH_BITS = 8;
+  static constexpr const std::size_t HASH_SIZE = std::size_t{1} << HASH_BITS;
+
+  // the last size bytes of the dictionary, older bytes are out of reach
+  static std::string_view tail(std::string_view dictionary, std::size_t size);
+
+  void emitLiteral(std::string& out, char value);
+  void emitMatch(std::string& out, std::size_t offset, std::size_t length);
+  void nextFlag(std::string& out);
+  void push(char value);
+  static std::size_t hash(char first, char second, char third);
+
+  std::unique_ptr<char[]> m_window;
+  // latest position per hash of 3 bytes and the previous position of each position,
+  // positions are truncated to 16 bits, candidates are verified against the window
+  std::unique_ptr<std::uint16_t[]> m_head;
+  std::unique_ptr<std::uint16_t[]> m_chain;
+  std::string m_dictionary;
+  // absolute position of the next byte, the window holds the preceding bytes
+  std::size_t m_position = 0;
+  std::size_t m_flagOffset = 0;
+  unsigned m_flagBit = 0;
+};
+
+}  // namespace yal
+
+#endif  // YAL_COMPRESSOR_HPP
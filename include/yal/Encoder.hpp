@@ -0,0 +1,74 @@
+//
+// Copyright (c) 2022 Alexander Mohr
+// Licensed under the terms of the MIT License
+//
+
+#ifndef YAL_ENCODER_HPP
+#define YAL_ENCODER_HPP
+
+#include <yal/Field.hpp>
+#include <yal/Level.hpp>
+#include <yal/LogRecord.hpp>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace yal {
+
+/**
+ * Output encoding of an appender.
+ * TEXT uses the format of the appender,
+ * JSON and CBOR ignore the format and write one object per message.
+ */
+enum class Encoding : std::uint8_t { TEXT, JSON, CBOR };
+
+class Encoder {
+ public:
+  static constexpr const auto FORMAT_TIME = 't';
+  static constexpr const auto FORMAT_MSG = 'm';
+  static constexpr const auto FORMAT_CONTEXT = 'c';
+  static constexpr const auto FORMAT_LEVEL = 'l';
+  static constexpr const auto FORMAT_FIELDS = 'k';
+  static constexpr const auto FORMAT_SOURCE = 's';
+
+  static constexpr const char* const KEY_TIME = "time";
+  static constexpr const char* const KEY_LEVEL = "level";
+  static constexpr const char* const KEY_CONTEXT = "context";
+  static constexpr const char* const KEY_MSG = "message";
+
+  /**
+   * Encode a message in a single pass and append it to out.
+   * @return false if nothing has to be written, i.e. the text format is empty
+   */
+  static bool encode(
+    Encoding encoding,
+    std::string& out,
+    const std::string& format,
+    const LogRecord& record);
+
+  static bool encodeText(
+    std::string& out,
+    const std::string& format,
+    const LogRecord& record);
+
+  static void encodeJson(std::string& out, const LogRecord& record);
+
+  static void encodeCbor(std::string& out, const LogRecord& record);
+
+  /**
+   * Append text as quoted and escaped JSON string
+   */
+  static void writeJsonString(std::string& out, std::string_view text);
+
+ private:
+  static void writeFieldText(std::string& out, const Field& field);
+  static void writeJsonValue(std::string& out, const Field& field);
+  static void writeCborHead(std::string& out, std::uint8_t major, std::uint64_t value);
+  static void writeCborString(std::string& out, std::string_view text);
+  static void writeCborValue(std::string& out, const Field& field);
+  static std::string_view levelName(const Level& level);
+};
+
+}  // namespace yal
+
+#endif  // YAL_ENCODER_HPP
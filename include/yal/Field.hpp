@@ -0,0 +1,149 @@
+//
+// Copyright (c) 2022 Alexander Mohr
+// Licensed under the terms of the MIT License
+//
+
+#ifndef YAL_FIELD_HPP
+#define YAL_FIELD_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace yal {
+
+/**
+ * Typed key value pair which can be attached to a log call.
+ * A field never owns its key or value, it only references them.
+ * This is safe as fields only live for the duration of the log call.
+ */
+class Field {
+ public:
+  enum class Type : std::uint8_t { BOOL, INT, UINT, DOUBLE, STRING };
+
+  Field(const char* key, bool value) : m_key(key), m_type(Type::BOOL) {
+    m_value.b = value;
+  }
+
+  template<
+    typename T,
+    std::enable_if_t<std::is_integral_v<T> && std::is_signed_v<T>, int> = 0>
+  Field(const char* key, T value) : m_key(key), m_type(Type::INT) {
+    m_value.i = value;
+  }
+
+  template<
+    typename T,
+    std::enable_if_t<
+      std::is_integral_v<T> && std::is_unsigned_v<T> && !std::is_same_v<T, bool>,
+      int> = 0>
+  Field(const char* key, T value) : m_key(key), m_type(Type::UINT) {
+    m_value.u = value;
+  }
+
+  template<typename T, std::enable_if_t<std::is_floating_point_v<T>, int> = 0>
+  Field(const char* key, T value) : m_key(key), m_type(Type::DOUBLE) {
+    m_value.d = value;
+  }
+
+  Field(const char* key, const char* value) : m_key(key), m_type(Type::STRING) {
+    m_value.s = {value, value == nullptr ? 0 : std::strlen(value)};
+  }
+
+  Field(const char* key, std::string_view value) : m_key(key), m_type(Type::STRING) {
+    m_value.s = {value.data(), value.size()};
+  }
+
+  Field(const char* key, const std::string& value) :
+      Field(key, std::string_view(value)) {
+  }
+
+  [[nodiscard]] const char* key() const {
+    return m_key;
+  }
+
+  [[nodiscard]] Type type() const {
+    return m_type;
+  }
+
+  [[nodiscard]] bool asBool() const {
+    return m_value.b;
+  }
+
+  [[nodiscard]] std::int64_t asInt() const {
+    return m_value.i;
+  }
+
+  [[nodiscard]] std::uint64_t asUInt() const {
+    return m_value.u;
+  }
+
+  [[nodiscard]] double asDouble() const {
+    return m_value.d;
+  }
+
+  [[nodiscard]] std::string_view asString() const {
+    return {m_value.s.data, m_value.s.size};
+  }
+
+ private:
+  const char* m_key;
+  Type m_type;
+  union {
+    bool b;
+    std::int64_t i;
+    std::uint64_t u;
+    double d;
+    struct {
+      const char* data;
+      std::size_t size;
+    } s;
+  } m_value{};
+};
+
+/**
+ * Non owning view of the fields passed to a log call.
+ * Created from a braced list, the fields are stored on the callers stack
+ * so attaching them to a message does not allocate:
+ * logger.log(Level::INFO, {{"sensor", "temp"}, {"value", 21.5}}, "reading");
+ */
+class Fields {
+ public:
+  Fields() = default;
+
+  Fields(const std::initializer_list<Field>& fields) :
+      m_data(std::data(fields)), m_size(fields.size()) {
+  }
+
+  Fields(const Field* data, std::size_t size) : m_data(data), m_size(size) {
+  }
+
+  [[nodiscard]] const Field* begin() const {
+    return m_data;
+  }
+
+  [[nodiscard]] const Field* end() const {
+    return m_data + m_size;
+  }
+
+  [[nodiscard]] std::size_t size() const {
+    return m_size;
+  }
+
+  [[nodiscard]] bool empty() const {
+    return m_size == 0;
+  }
+
+ private:
+  const Field* m_data = nullptr;
+  std::size_t m_size = 0;
+};
+
+}  // namespace yal
+
+#endif  // YAL_FIELD_HPP
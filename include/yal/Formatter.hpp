@@ -0,0 +1,112 @@
+//
+// Copyright (c) 2022 Alexander Mohr
+// Licensed under the terms of the MIT License
+//
+
+#ifndef YAL_FORMATTER_HPP
+#define YAL_FORMATTER_HPP
+
+#include <yal/abstraction.hpp>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace yal {
+
+/**
+ * Appends values to a string without allocating beyond the growth of the string.
+ * Built-in types are written directly, other types fall back to operator<<
+ * of a stringstream, which allocates.
+ */
+class Formatter {
+ public:
+  template<typename T>
+  static void write(std::string& out, const T& value) {
+    using Type = std::decay_t<T>;
+    if constexpr (std::is_same_v<Type, bool>) {
+      // matches std::ostream without std::boolalpha
+      out += value ? '1' : '0';
+    } else if constexpr (
+      std::is_same_v<Type, char> || std::is_same_v<Type, signed char>
+      || std::is_same_v<Type, unsigned char>)
+    {
+      out += static_cast<char>(value);
+    } else if constexpr (std::is_integral_v<Type> && std::is_signed_v<Type>) {
+      writeInteger(out, static_cast<std::int64_t>(value));
+    } else if constexpr (std::is_integral_v<Type>) {
+      writeUnsigned(out, static_cast<std::uint64_t>(value));
+    } else if constexpr (std::is_floating_point_v<Type>) {
+      writeDouble(out, static_cast<double>(value));
+    } else if constexpr (
+      std::is_same_v<Type, const char*> || std::is_same_v<Type, char*>)
+    {
+      const char* const text = value;
+      if (text != nullptr) {
+        out.append(text);
+      }
+    } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+      out.append(std::string_view(value));
+    } else {
+      std::ostringstream ss;
+      ss << value;
+      out.append(ss.str());
+    }
+  }
+
+  static void writeInteger(std::string& out, std::int64_t value);
+  static void writeUnsigned(std::string& out, std::uint64_t value);
+  // uses %g, which matches the default formatting of std::ostream
+  static void writeDouble(std::string& out, double value);
+};
+
+/**
+ * String buffer which keeps its capacity between messages,
+ * so logging does not allocate once it has grown to the longest message.
+ * The buffer is thread local on hosted builds.
+ * Nested use, i.e. logging from within an appender, falls back to a local string.
+ * @tparam Tag distinguishes independent buffers
+ */
+template<typename Tag>
+class ScratchBuffer {
+ public:
+  ScratchBuffer() : m_owner(!s_inUse), m_buffer(m_owner ? s_buffer : m_local) {
+    s_inUse = true;
+    m_buffer.clear();
+  }
+
+  ScratchBuffer(const ScratchBuffer&) = delete;
+  ScratchBuffer(ScratchBuffer&&) = delete;
+  ScratchBuffer& operator=(const ScratchBuffer&) = delete;
+  ScratchBuffer& operator=(ScratchBuffer&&) = delete;
+
+  ~ScratchBuffer() {
+    if (m_owner) {
+      s_inUse = false;
+    }
+  }
+
+  std::string& str() {
+    return m_buffer;
+  }
+
+  /**
+   * Preallocate the buffer of the calling thread
+   */
+  static void reserve(std::size_t size) {
+    s_buffer.reserve(size);
+  }
+
+ private:
+  static inline YAL_THREAD_LOCAL std::string s_buffer;
+  static inline YAL_THREAD_LOCAL bool s_inUse = false;
+
+  const bool m_owner;
+  std::string m_local;
+  std::string& m_buffer;
+};
+
+}  // namespace yal
+
+#endif  // YAL_FORMATTER_HPP
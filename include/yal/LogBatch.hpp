@@ -0,0 +1,99 @@
+//
+// Copyright (c) 2022 Alexander Mohr
+// Licensed under the terms of the MIT License
+//
+
+#ifndef YAL_LOGBATCH_HPP
+#define YAL_LOGBATCH_HPP
+
+#include <yal/Level.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace yal {
+
+/**
+ * Encoded messages staged by one thread, in the order they were logged.
+ * A batch is a view, it is only valid during the appendBatch call.
+ */
+class LogBatch {
+ public:
+  struct Entry {
+    std::uint64_t sequence;
+    Level level;
+    // encoded message, followed by a null byte which is not part of the view
+    std::string_view data;
+  };
+
+  class Iterator {
+   public:
+    explicit Iterator(std::string_view data) : m_data(data) {
+    }
+
+    Entry operator*() const {
+      std::uint64_t sequence = 0;
+      std::uint32_t size = 0;
+      std::memcpy(&sequence, m_data.data(), sizeof(sequence));
+      const auto level = static_cast<Level::Value>(m_data[sizeof(sequence)]);
+      std::memcpy(&size, m_data.data() + sizeof(sequence) + 1, sizeof(size));
+      return {sequence, level, m_data.substr(HEADER_SIZE, size)};
+    }
+
+    Iterator& operator++() {
+      std::uint32_t size = 0;
+      std::memcpy(&size, m_data.data() + sizeof(std::uint64_t) + 1, sizeof(size));
+      m_data.remove_prefix(HEADER_SIZE + size + 1);
+      return *this;
+    }
+
+    bool operator!=(const Iterator& other) const {
+      return m_data.data() != other.m_data.data();
+    }
+
+   private:
+    std::string_view m_data;
+  };
+
+  // u64 sequence | u8 level | u32 size | data | '\0', in native byte order
+  static constexpr const std::size_t HEADER_SIZE =
+    sizeof(std::uint64_t) + sizeof(std::uint8_t) + sizeof(std::uint32_t);
+
+  LogBatch(std::string_view data, std::size_t size) : m_data(data), m_size(size) {
+  }
+
+  [[nodiscard]] Iterator begin() const {
+    return Iterator(m_data);
+  }
+
+  [[nodiscard]] Iterator end() const {
+    return Iterator(m_data.substr(m_data.size()));
+  }
+
+  /**
+   * Number of messages
+   */
+  [[nodiscard]] std::size_t size() const {
+    return m_size;
+  }
+
+  /**
+   * Append the header of an entry to a staging buffer
+   * @return offset of the size, which is patched once the message is encoded
+   */
+  static std::size_t writeHeader(
+    std::string& out,
+    std::uint64_t sequence,
+    const Level& level);
+  static void commit(std::string& out, std::size_t sizeOffset);
+
+ private:
+  std::string_view m_data;
+  std::size_t m_size;
+};
+
+}  // namespace yal
+
+#endif  // YAL_LOGBATCH_HPP
@@ -0,0 +1,73 @@
+//
+// Copyright (c) 2022 Alexander Mohr
+// Licensed under the terms of the MIT License
+//
+
+#ifndef YAL_LOGRECORD_HPP
+#define YAL_LOGRECORD_HPP
+
+#include <yal/Field.hpp>
+#include <yal/Level.hpp>
+#include <cstdint>
+#include <string_view>
+
+namespace yal {
+
+struct SourceLocation {
+  const char* file = "";
+  unsigned int line = 0;
+
+  /**
+   * Returns the location of the caller when used as default argument.
+   * Define YAL_DISABLE_SOURCE_LOCATION to keep file names out of the binary.
+   */
+#if defined(YAL_DISABLE_SOURCE_LOCATION)
+  static constexpr SourceLocation current() {
+    return {};
+  }
+#else
+  static constexpr SourceLocation current(
+    const char* file = __builtin_FILE(),
+    unsigned int line = __builtin_LINE()) {
+    return {file, line};
+  }
+#endif
+};
+
+/**
+ * Format string of a log call.
+ * Implicitly created from const char* to capture the source location of the caller.
+ */
+struct Format {
+  // NOLINTNEXTLINE(google-explicit-constructor)
+  constexpr Format(
+    const char* text,
+    const SourceLocation& location = SourceLocation::current()) :
+      text(text), location(location) {
+  }
+
+  const char* text;
+  SourceLocation location;
+};
+
+/**
+ * Everything known about a single log message.
+ * All members are views, a record is only valid during the append call.
+ */
+struct LogRecord {
+  Level level;
+  // millis() at the time of logging
+  unsigned long timestamp;
+  // time rendered by the function set via Logger::setTimeFunc
+  std::string_view time;
+  std::string_view context;
+  std::string_view message;
+  SourceLocation location;
+  Fields fields;
+  // global order of the message across threads, only set while staging is enabled
+  std::uint64_t sequence = 0;
+};
+
+}  // namespace yal
+
+#endif  // YAL_LOGRECORD_HPP
@@ -0,0 +1,138 @@
+//
+// Copyright (c) 2022 Alexander Mohr
+// Licensed under the terms of the MIT License
+//
+
+#ifndef YAL_METRICS_HPP
+#define YAL_METRICS_HPP
+
+#include <yal/Level.hpp>
+#include <yal/abstraction.hpp>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#if !(HAVE_ARDUINO || YAL_ARDUINO_SUPPORT)
+#include <atomic>
+#endif
+
+#ifndef YAL_METRICS
+// count messages and time the appenders, costs an atomic per message and
+// appender and two clock reads per append, rejected messages are counted as well
+#define YAL_METRICS 0
+#endif
+
+namespace yal {
+
+static constexpr const bool METRICS_ENABLED = YAL_METRICS;
+
+/**
+ * Lock free counter. Relaxed atomics on hosted builds,
+ * a plain integer on arduino where 32 bit accesses are atomic.
+ */
+class Counter {
+ public:
+  Counter() = default;
+  explicit Counter(std::uint32_t value) : m_value(value) {
+  }
+  Counter(const Counter& other) : m_value(other.load()) {
+  }
+  Counter& operator=(const Counter&) = delete;
+
+  void add(std::uint32_t value = 1) {
+#if !(HAVE_ARDUINO || YAL_ARDUINO_SUPPORT)
+    m_value.fetch_add(value, std::memory_order_relaxed);
+#else
+    m_value += value;
+#endif
+  }
+
+  /**
+   * Raise the counter to value if it is larger
+   */
+  void max(std::uint32_t value) {
+#if !(HAVE_ARDUINO || YAL_ARDUINO_SUPPORT)
+    auto current = m_value.load(std::memory_order_relaxed);
+    while (value > current
+           && !m_value.compare_exchange_weak(current, value, std::memory_order_relaxed))
+    {
+    }
+#else
+    if (value > m_value) {
+      m_value = value;
+    }
+#endif
+  }
+
+  void set(std::uint32_t value) {
+#if !(HAVE_ARDUINO || YAL_ARDUINO_SUPPORT)
+    m_value.store(value, std::memory_order_relaxed);
+#else
+    m_value = value;
+#endif
+  }
+
+  [[nodiscard]] std::uint32_t load() const {
+#if !(HAVE_ARDUINO || YAL_ARDUINO_SUPPORT)
+    return m_value.load(std::memory_order_relaxed);
+#else
+    return m_value;
+#endif
+  }
+
+ private:
+#if !(HAVE_ARDUINO || YAL_ARDUINO_SUPPORT)
+  std::atomic<std::uint32_t> m_value{0};
+#else
+  std::uint32_t m_value = 0;
+#endif
+};
+
+static constexpr const auto LEVEL_COUNT = static_cast<std::size_t>(Level::OFF) + 1;
+
+struct LoggerMetrics {
+  // messages passed to the appenders per level
+  std::array<Counter, LEVEL_COUNT> messages{};
+  // messages below the level only passed to capturing appenders, per level
+  std::array<Counter, LEVEL_COUNT> captured{};
+  // messages discarded because their level is disabled
+  std::array<Counter, LEVEL_COUNT> rejected{};
+  // messages discarded by the rate limiter
+  Counter rateLimited;
+
+  void reset();
+};
+
+struct AppenderMetrics {
+  // bucket i counts calls taking less than 2^i us, the last one all others
+  static constexpr const auto LATENCY_BUCKETS = 16U;
+
+  Counter messages;
+  // append() and appendBatch() calls, the latencies are measured per call
+  Counter calls;
+  // bytes encoded for this appender, not counted if append(LogRecord) is overridden
+  Counter bytes;
+  Counter maxLatencyUs;
+  std::array<Counter, LATENCY_BUCKETS> latencyUs{};
+
+  void recordLatency(unsigned long latencyUs, std::uint32_t messages = 1);
+  void reset();
+};
+
+class Metrics {
+ public:
+  /**
+   * Append the metrics as JSON object members, without enclosing braces
+   */
+  static void writeJson(std::string& out, const LoggerMetrics& metrics);
+  static void writeJson(std::string& out, const AppenderMetrics& metrics);
+
+ private:
+  template<typename Counters>
+  static void writeArray(std::string& out, const char* key, const Counters& counters);
+};
+
+}  // namespace yal
+
+#endif  // YAL_METRICS_HPP
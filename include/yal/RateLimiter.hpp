@@ -0,0 +1,121 @@
+//
+// Copyright (c) 2022 Alexander Mohr
+// Licensed under the terms of the MIT License
+//
+
+#ifndef YAL_RATELIMITER_HPP
+#define YAL_RATELIMITER_HPP
+
+#include <yal/Level.hpp>
+#include <yal/LogRecord.hpp>
+#include <yal/abstraction.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifndef YAL_RATE_LIMIT_SITES
+// number of call sites tracked by the rate limiter
+#define YAL_RATE_LIMIT_SITES 32
+#endif
+
+#ifndef YAL_RATE_LIMIT_CONTEXT_SIZE
+// characters of the logger context kept per call site to report summaries
+#define YAL_RATE_LIMIT_CONTEXT_SIZE 16
+#endif
+
+namespace yal {
+
+/**
+ * Limits applied to each call site,
+ * identified by format string address, logger context and level.
+ * A default constructed limit does not restrict anything.
+ */
+struct RateLimit {
+  // token bucket size, messages which can be logged in a burst. 0 disables the bucket
+  std::uint16_t burst = 0;
+  // tokens added to the bucket per second
+  std::uint16_t perSecond = 0;
+  // repetitions of a call site within this window in ms are collapsed. 0 disables
+  std::uint32_t duplicateWindow = 0;
+
+  [[nodiscard]] bool enabled() const {
+    return burst != 0 || duplicateWindow != 0;
+  }
+};
+
+class RateLimiter {
+ public:
+  struct Result {
+    bool allowed;
+    // number of messages suppressed since the last allowed message of the call site
+    std::uint32_t suppressed;
+    // the duplicate window of another call site with suppressed messages has expired,
+    // see takeSummaries
+    bool summariesDue;
+  };
+
+  // messages suppressed at a call site which has not logged since
+  struct Summary {
+    std::string context;
+    Level level;
+    SourceLocation location;
+    std::uint32_t suppressed;
+  };
+
+  /**
+   * Decide whether a message of a call site may be logged.
+   * This is a hash lookup and does not require the message to be formatted.
+   * Call sites which do not fit into the table are never limited.
+   * The table is allocated by the first check, so it only takes memory
+   * once a limit is enabled. Contexts are told apart by their hash,
+   * summaries carry the first YAL_RATE_LIMIT_CONTEXT_SIZE characters.
+   */
+  Result check(
+    const Format& format,
+    std::string_view context,
+    const Level& level,
+    const RateLimit& limit,
+    unsigned long now);
+
+  /**
+   * Move the suppressed messages of call sites whose duplicate window has expired,
+   * or of all call sites if all is set, into out
+   */
+  void takeSummaries(std::vector<Summary>& out, unsigned long now, bool all);
+
+  void reset();
+
+ private:
+  static constexpr const std::size_t CONTEXT_SIZE = YAL_RATE_LIMIT_CONTEXT_SIZE;
+
+  struct Site {
+    const void* key = nullptr;
+    std::uint32_t contextHash = 0;
+    char context[CONTEXT_SIZE] = {};
+    std::uint8_t contextLength = 0;
+    Level::Value level = Level::OFF;
+    SourceLocation location;
+    // tokens are stored in thousandths to refill with millisecond resolution
+    std::uint32_t milliTokens = 0;
+    unsigned long lastRefill = 0;
+    unsigned long lastAllowed = 0;
+    std::uint32_t duplicateWindow = 0;
+    std::uint32_t suppressed = 0;
+  };
+
+  Site* find(const void* site, std::uint32_t contextHash, const Level& level);
+  void schedule(const Site& site);
+
+  Mutex m_mutex;
+  std::unique_ptr<Site[]> m_sites;
+  // earliest expiry of a duplicate window with suppressed messages
+  bool m_scheduled = false;
+  unsigned long m_nextSummary = 0;
+};
+
+}  // namespace yal
+
+#endif  // YAL_RATELIMITER_HPP
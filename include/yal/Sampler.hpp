@@ -0,0 +1,124 @@
+//
+// Copyright (c) 2022 Alexander Mohr
+// Licensed under the terms of the MIT License
+//
+
+#ifndef YAL_SAMPLER_HPP
+#define YAL_SAMPLER_HPP
+
+#include <cstdint>
+#include <limits>
+
+namespace yal {
+
+/**
+ * Base of all samplers. Samplers are meant to be declared static at the call site
+ * and passed to Logger::log, which checks them before anything else:
+ *
+ * static yal::EveryN every100(100);
+ * logger.log(every100, yal::Level::DEBUG, "value %", value);
+ *
+ * The state is not synchronized, concurrent calls may sample slightly off.
+ */
+class Sampler {};
+
+/**
+ * Samples the first and then every nth occurrence
+ */
+class EveryN : public Sampler {
+ public:
+  explicit constexpr EveryN(std::uint32_t n) : m_n(n == 0 ? 1 : n) {
+  }
+
+  bool sample() {
+    const auto result = m_count == 0;
+    if (++m_count == m_n) {
+      m_count = 0;
+    }
+    return result;
+  }
+
+ private:
+  const std::uint32_t m_n;
+  std::uint32_t m_count = 0;
+};
+
+/**
+ * Samples the first n occurrences, afterwards occurrence 2n, 4n, 8n, ...
+ */
+class FirstNThenBackoff : public Sampler {
+ public:
+  explicit constexpr FirstNThenBackoff(std::uint32_t n) :
+      m_n(n == 0 ? 1 : n), m_next(m_n * 2) {
+  }
+
+  bool sample() {
+    if (m_count == std::numeric_limits<std::uint32_t>::max()) {
+      return false;
+    }
+
+    ++m_count;
+    if (m_count <= m_n) {
+      return true;
+    }
+
+    if (m_count == m_next) {
+      m_next = m_next > std::numeric_limits<std::uint32_t>::max() / 2
+                 ? std::numeric_limits<std::uint32_t>::max()
+                 : m_next * 2;
+      return true;
+    }
+    return false;
+  }
+
+ private:
+  const std::uint32_t m_n;
+  std::uint32_t m_next;
+  std::uint32_t m_count = 0;
+};
+
+/**
+ * Samples each occurrence with a fixed probability
+ * using a xorshift generator, which only needs a few shifts per call.
+ */
+class Probability : public Sampler {
+ public:
+  /**
+   * @param probability value between 0 (never) and 1 (always)
+   * @param seed seed of the generator, must not be 0
+   */
+  explicit constexpr Probability(double probability, std::uint32_t seed = DEFAULT_SEED) :
+      m_threshold(threshold(probability)), m_state(seed == 0 ? DEFAULT_SEED : seed) {
+  }
+
+  bool sample() {
+    static constexpr const auto shift1 = 13U;
+    static constexpr const auto shift2 = 17U;
+    static constexpr const auto shift3 = 5U;
+    m_state ^= m_state << shift1;
+    m_state ^= m_state >> shift2;
+    m_state ^= m_state << shift3;
+    return m_state < m_threshold;
+  }
+
+ private:
+  static constexpr std::uint64_t threshold(double probability) {
+    constexpr const auto range = static_cast<double>(1ULL << 32U);
+    if (probability <= 0) {
+      return 0;
+    }
+    if (probability >= 1) {
+      return 1ULL << 32U;
+    }
+    return static_cast<std::uint64_t>(probability * range);
+  }
+
+  static constexpr const std::uint32_t DEFAULT_SEED = 2463534242U;
+
+  const std::uint64_t m_threshold;
+  std::uint32_t m_state;
+};
+
+}  // namespace yal
+
+#endif  // YAL_SAMPLER_HPP
@@ -0,0 +1,132 @@
+//
+// Copyright (c) 2022 Alexander Mohr
+// Licensed under the terms of the MIT License
+//
+
+#ifndef YAL_SPAN_HPP
+#define YAL_SPAN_HPP
+
+#include <yal/Metrics.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#ifndef YAL_TRACE_BUFFER_SIZE
+// bytes buffered per thread until the trace is drained, a span takes 19 bytes + names
+#define YAL_TRACE_BUFFER_SIZE 4096
+#endif
+
+namespace yal {
+
+class Logger;
+
+/**
+ * Collects finished spans in a binary buffer per thread.
+ * Buffers are drained into a portable binary trace, which can be converted
+ * to the Chrome Trace Event format on the device or on the host,
+ * i.e. after sending it via MQTT. Open the JSON in chrome://tracing or Perfetto.
+ */
+class Tracer {
+ public:
+  /**
+   * Monotonic timestamp in nanoseconds.
+   * Derived from micros() on arduino, so the resolution is 1us there.
+   */
+  static std::uint64_t now();
+
+  /**
+   * Spans are recorded by default. Disabled spans only cost a load and a branch.
+   */
+  static void setEnabled(bool enabled) {
+    s_enabled.set(enabled ? 1 : 0);
+  }
+
+  [[nodiscard]] static bool enabled() {
+    return s_enabled.load() != 0;
+  }
+
+  /**
+   * Store a finished span in the buffer of the calling thread.
+   * Dropped if the buffer is full.
+   */
+  static void record(
+    std::uint64_t begin,
+    std::uint64_t end,
+    std::uint8_t depth,
+    std::string_view name,
+    std::string_view category);
+
+  /**
+   * Append the spans of all threads as binary trace to out and clear the buffers.
+   * All values are in native byte order:
+   * per thread u32 thread id | u32 length | spans
+   * per span u64 begin ns | u64 duration ns | u8 depth
+   *          | u8 name length | name | u8 category length | category
+   */
+  static void drain(std::string& out);
+
+  /**
+   * Convert a binary trace created by drain() to Chrome Trace Event JSON
+   * @return false if the trace is truncated, out contains all complete spans
+   */
+  static bool writeChromeTrace(std::string& out, std::string_view trace);
+
+  /**
+   * Drain all threads and convert the trace to Chrome Trace Event JSON
+   */
+  static void writeChromeTrace(std::string& out);
+
+  /**
+   * Spans dropped because the buffer of their thread was full
+   */
+  [[nodiscard]] static std::uint32_t dropped() {
+    return s_dropped.load();
+  }
+
+  /**
+   * Nesting depth of open spans on the calling thread
+   */
+  static std::uint8_t& depth();
+
+ private:
+  struct Buffer;
+  struct Registry;
+  static Buffer& buffer();
+  static Registry& registry();
+
+  static inline Counter s_enabled{1};
+  static inline Counter s_dropped;
+};
+
+/**
+ * Measures the scope it lives in:
+ *
+ * void loop() {
+ *   yal::Span span(logger, "loop");
+ *   ...
+ * }
+ *
+ * The span is recorded with the context of the logger as category when it ends,
+ * name and context are copied into the trace buffer at that point.
+ */
+class Span {
+ public:
+  Span(const Logger& logger, const char* name);
+  ~Span();
+
+  Span(const Span&) = delete;
+  Span(Span&&) = delete;
+  Span& operator=(const Span&) = delete;
+  Span& operator=(Span&&) = delete;
+
+ private:
+  const Logger& m_logger;
+  const char* const m_name;
+  const bool m_active;
+  std::uint64_t m_begin = 0;
+};
+
+}  // namespace yal
+
+#endif  // YAL_SPAN_HPP
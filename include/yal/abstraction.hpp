@@ -8,6 +8,10 @@
 
 #if !(HAVE_ARDUINO || YAL_ARDUINO_SUPPORT)
 
+#ifndef YAL_THREAD_LOCAL
+#define YAL_THREAD_LOCAL thread_local
+#endif
+
 #ifndef delay
 void delay(unsigned long millis);
 #endif
@@ -22,8 +26,54 @@ using String = std::string;
 unsigned long millis();
 #endif
 
+#ifndef micros
+unsigned long micros();
+#endif
+
+#include <mutex>
+namespace yal {
+using Mutex = std::mutex;
+using LockGuard = std::lock_guard<Mutex>;
+using RecursiveMutex = std::recursive_mutex;
+using RecursiveLockGuard = std::lock_guard<RecursiveMutex>;
+}  // namespace yal
+
 #else
 #include <Arduino.h>
+
+// thread_local is emulated on arduino and allocates on first use,
+// logging is expected to happen on a single thread
+#ifndef YAL_THREAD_LOCAL
+#define YAL_THREAD_LOCAL
+#endif
+
+// <mutex> is not available on every arduino core
+namespace yal {
+struct Mutex {
+  void lock() {
+  }
+  void unlock() {
+  }
+};
+
+class LockGuard {
+ public:
+  explicit LockGuard(Mutex& mutex) : m_mutex(mutex) {
+    m_mutex.lock();
+  }
+  LockGuard(const LockGuard&) = delete;
+  LockGuard& operator=(const LockGuard&) = delete;
+  ~LockGuard() {
+    m_mutex.unlock();
+  }
+
+ private:
+  Mutex& m_mutex;
+};
+
+using RecursiveMutex = Mutex;
+using RecursiveLockGuard = LockGuard;
+}  // namespace yal
 #endif
 
 #endif  // YAL_ABSTRACTION_HPP
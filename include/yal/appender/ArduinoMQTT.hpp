@@ -6,8 +6,11 @@
 #ifndef YAL_MQTTAPPENDER
 #define YAL_MQTTAPPENDER
 
+#include <yal/Compressor.hpp>
 #include <yal/abstraction.hpp>
 #include <yal/yal.hpp>
+#include <cstdint>
+#include <memory>
 #include <queue>
 #include <utility>
 
@@ -18,6 +21,8 @@ namespace yal::appender {
 struct MqttMessage {
   String topic;
   String message;
+  // binary messages (i.e. CBOR) are published with an explicit length
+  bool binary = false;
 };
 
 template<typename MQTT>
@@ -79,9 +84,19 @@ class ArduinoMQTT : public Appender {
    * Only call this when not running an ISR
    */
   void flush() {
+    finishBatch();
+    if (!m_statsTopic.empty() && millis() - m_lastStats >= m_statsInterval) {
+      publishStats();
+    }
+
     while (!m_mqtt_msg_queue.empty()) {
       const auto& msg = m_mqtt_msg_queue.front();
-      m_mqtt->publish(msg.topic, msg.message);
+      if (msg.binary) {
+        m_mqtt->publish(
+          msg.topic.c_str(), msg.message.c_str(), static_cast<int>(msg.message.length()));
+      } else {
+        m_mqtt->publish(msg.topic, msg.message);
+      }
       m_mqtt_msg_queue.pop();
     }
   }
@@ -112,12 +127,162 @@ class ArduinoMQTT : public Appender {
     return m_topic.c_str();
   }
 
+  /**
+   * Limit the number of queued log messages.
+   * Further messages are dropped until the queue is flushed.
+   * @param size maximum queue size, 0 for no limit
+   */
+  void setMaxQueueSize(std::size_t size) {
+    m_maxQueueSize = size;
+  }
+
+  /**
+   * Combine messages into payloads of about maxPayload bytes
+   * instead of publishing every message on its own.
+   * Text messages are separated by a newline, CBOR messages form a CBOR sequence.
+   * A payload is queued once it is full or on flush.
+   * @param maxPayload payload size in bytes, 0 for one message per payload (default)
+   */
+  void setBatching(std::size_t maxPayload) {
+    finishBatch();
+    m_maxPayload = maxPayload;
+    m_batch.reserve(maxPayload);
+  }
+
+  /**
+   * Compress payloads with a streaming LZSS compressor, see Compressor.
+   * Compressed payloads are binary, decode them with Compressor::decompress
+   * and the same dictionary. The window is allocated once here.
+   * @param dictionary primes every payload,
+   *                   i.e. Compressor::dictionary(format(), {"default"})
+   */
+  void enableCompression(std::string_view dictionary) {
+    finishBatch();
+    m_compressor = std::make_unique<Compressor>(dictionary);
+  }
+
+  void disableCompression() {
+    finishBatch();
+    m_compressor.reset();
+  }
+
+  /**
+   * Log messages dropped because the queue was full
+   */
+  [[nodiscard]] std::uint32_t dropped() const {
+    return m_dropped.load();
+  }
+
+  /**
+   * Largest queue size seen since construction
+   */
+  [[nodiscard]] std::uint32_t maxQueueDepth() const {
+    return m_maxQueueDepth.load();
+  }
+
+  /**
+   * Periodically publish the logger and appender metrics as JSON object.
+   * The metrics are queued by flush once the interval has elapsed.
+   * @param topic topic for the metrics, empty to disable
+   * @param intervalMs minimum time between two publications
+   */
+  void setStatsTopic(const char* const topic, unsigned long intervalMs) {
+    m_statsTopic = topic;
+    m_statsInterval = intervalMs;
+    m_lastStats = millis();
+  }
+
+  /**
+   * Queue the metrics for the stats topic now
+   */
+  void publishStats() {
+    m_lastStats = millis();
+    std::string json = "{\"queue\":";
+    Formatter::writeUnsigned(json, m_mqtt_msg_queue.size());
+    json += ",\"maxQueue\":";
+    Formatter::writeUnsigned(json, m_maxQueueDepth.load());
+    json += ",\"dropped\":";
+    Formatter::writeUnsigned(json, m_dropped.load());
+    json += ',';
+    Metrics::writeJson(json, Logger::metrics());
+    json += ',';
+    Metrics::writeJson(json, metrics());
+    json += '}';
+    m_mqtt_msg_queue.push(
+      {String(m_statsTopic.c_str()), toString(json.data(), json.size())});
+  }
+
  protected:
   void append(const Level& level, const char* text) override {
-    m_mqtt_msg_queue.push({String(m_topic.c_str()), String(text)});
+    appendEncoded(level, text, std::char_traits<char>::length(text));
+  }
+
+  void appendEncoded(const Level& level, const char* data, std::size_t size) override {
+    if (m_maxPayload == 0 && !m_compressor) {
+      enqueue(data, size, encoding() == Encoding::CBOR, 1);
+      return;
+    }
+
+    if (m_batchMessages == 0) {
+      if (m_compressor) {
+        m_compressor->begin(m_batch);
+      }
+    } else if (encoding() != Encoding::CBOR) {
+      writeBatch("\n", 1);
+    }
+    writeBatch(data, size);
+    ++m_batchMessages;
+
+    if (m_batch.size() >= m_maxPayload) {
+      finishBatch();
+    }
   }
 
  private:
+  void enqueue(
+    const char* data,
+    std::size_t size,
+    bool binary,
+    std::uint32_t messages) {
+    if (m_maxQueueSize != 0 && m_mqtt_msg_queue.size() >= m_maxQueueSize) {
+      m_dropped.add(messages);
+      return;
+    }
+
+    m_mqtt_msg_queue.push({String(m_topic.c_str()), toString(data, size), binary});
+    m_maxQueueDepth.max(static_cast<std::uint32_t>(m_mqtt_msg_queue.size()));
+  }
+
+  void writeBatch(const char* data, std::size_t size) {
+    if (m_compressor) {
+      m_compressor->write(m_batch, data, size);
+    } else {
+      m_batch.append(data, size);
+    }
+  }
+
+  void finishBatch() {
+    if (m_batchMessages == 0) {
+      return;
+    }
+
+    const auto binary = m_compressor || encoding() == Encoding::CBOR;
+    enqueue(m_batch.data(), m_batch.size(), binary, m_batchMessages);
+    m_batch.clear();
+    m_batchMessages = 0;
+  }
+
+  static String toString(const char* data, std::size_t size) {
+#if !(HAVE_ARDUINO || YAL_ARDUINO_SUPPORT)
+    return String(data, size);
+#else
+    // arduino String has no public constructor taking a length
+    String str;
+    str.concat(data, size);
+    return str;
+#endif
+  }
+
   void changeLevel(const char* const levelValue) {
     std::stringstream ss(levelValue);
     int level;
@@ -135,6 +300,19 @@ class ArduinoMQTT : public Appender {
 
   std::queue<MqttMessage> m_mqtt_msg_queue;
   Logger m_logger;
+
+  std::size_t m_maxPayload = 0;
+  std::unique_ptr<Compressor> m_compressor;
+  std::string m_batch;
+  std::uint32_t m_batchMessages = 0;
+
+  std::size_t m_maxQueueSize = 0;
+  Counter m_dropped;
+  Counter m_maxQueueDepth;
+
+  std::string m_statsTopic;
+  unsigned long m_statsInterval = 0;
+  unsigned long m_lastStats = 0;
 };
 
 }  // namespace yal::appender
@@ -0,0 +1,125 @@
+//
+// Copyright (c) 2022 Alexander Mohr
+// Licensed under the terms of the MIT License
+//
+
+#ifndef YAL_FLIGHTRECORDER_HPP
+#define YAL_FLIGHTRECORDER_HPP
+
+#include <yal/yal.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace yal::appender {
+
+/**
+ * Keeps the most recent messages, including those below Logger::level(),
+ * in a preallocated circular buffer. When a message at or above the dump level
+ * is logged the history is replayed to all other appenders.
+ * This gives trace context for errors without sending trace messages continuously.
+ *
+ * Source locations are not recorded.
+ */
+class FlightRecorder : public Appender {
+ public:
+  /**
+   * Create a flight recorder backed by memory allocated once at construction
+   * @param storage pointer to appender storage, might be instance of logger
+   * @param capacity size of the circular buffer in bytes
+   * @param captureLevel lowest level that is recorded
+   * @param dumpLevel messages at or above this level trigger a dump
+   */
+  FlightRecorder(
+    AppenderStorage* storage,
+    std::size_t capacity,
+    const Level& captureLevel = Level::TRACE,
+    const Level& dumpLevel = Level::ERROR);
+
+#if defined(__linux__) && !(HAVE_ARDUINO || YAL_ARDUINO_SUPPORT)
+  /**
+   * Create a flight recorder backed by a memory mapped file.
+   * The history survives a crash of the process, an existing file with the same
+   * capacity is reused and can be replayed with dumpAll().
+   * Falls back to heap memory if the file cannot be mapped.
+   * @param path file backing the circular buffer
+   */
+  FlightRecorder(
+    AppenderStorage* storage,
+    std::size_t capacity,
+    const char* path,
+    const Level& captureLevel = Level::TRACE,
+    const Level& dumpLevel = Level::ERROR);
+#endif
+
+  FlightRecorder(const FlightRecorder&) = delete;
+  FlightRecorder(FlightRecorder&&) = delete;
+  ~FlightRecorder() override;
+
+  void append(const LogRecord& record) override;
+
+  [[nodiscard]] bool supportsStaging() const override {
+    return false;
+  }
+
+  /**
+   * Replay all recorded messages which were below the logger level
+   * when they were recorded, and clear the history afterwards.
+   * Messages that already reached the other appenders are not sent again.
+   */
+  void dump();
+
+  /**
+   * Replay the complete history, i.e. after recovering a memory mapped file,
+   * and clear it afterwards.
+   */
+  void dumpAll();
+
+  void clear();
+
+  void setDumpLevel(const Level& level) {
+    m_dumpLevel = level;
+  }
+
+  /**
+   * Currently used bytes of the circular buffer
+   */
+  [[nodiscard]] std::size_t size() const;
+
+  [[nodiscard]] std::size_t capacity() const;
+
+  [[nodiscard]] bool memoryMapped() const {
+    return m_mapping != nullptr;
+  }
+
+ private:
+  struct Header {
+    std::uint32_t magic;
+    std::uint32_t capacity;
+    std::uint32_t head;
+    std::uint32_t size;
+  };
+
+  void init(std::uint8_t* memory, std::size_t capacity, bool keepContent);
+  void replay(bool all);
+  void dropOldest();
+  void write(std::size_t& offset, const void* data, std::size_t size);
+  void read(std::size_t offset, void* data, std::size_t size) const;
+
+  static constexpr const std::uint32_t MAGIC = 0x59414c46;  // YALF
+
+  std::unique_ptr<std::uint8_t[]> m_memory;
+  void* m_mapping = nullptr;
+  std::size_t m_mappingSize = 0;
+  Header* m_header = nullptr;
+  std::uint8_t* m_data = nullptr;
+  std::vector<char> m_scratch;
+  Level m_dumpLevel;
+  bool m_replaying = false;
+};
+
+}  // namespace yal::appender
+
+#endif  // YAL_FLIGHTRECORDER_HPP
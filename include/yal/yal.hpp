@@ -6,7 +6,17 @@
 #ifndef YAL_YAL_HPP
 #define YAL_YAL_HPP
 
+#include <yal/Argument.hpp>
+#include <yal/Encoder.hpp>
+#include <yal/Field.hpp>
+#include <yal/Formatter.hpp>
 #include <yal/Level.hpp>
+#include <yal/LogBatch.hpp>
+#include <yal/LogRecord.hpp>
+#include <yal/Metrics.hpp>
+#include <yal/RateLimiter.hpp>
+#include <yal/Sampler.hpp>
+#include <yal/Span.hpp>
 #include <yal/abstraction.hpp>
 #include <array>
 #include <cstddef>
@@ -14,8 +24,10 @@
 #include <iomanip>
 #include <limits>
 #include <map>
+#include <optional>
 #include <sstream>
 #include <string>
+#include <type_traits>
 #include <utility>
 namespace yal {
 
@@ -28,6 +40,19 @@ class AppenderStorage {
  public:
   [[nodiscard]] virtual AppenderId addAppender(Appender* appender) = 0;
   virtual void removeAppender(AppenderId appenderId) = 0;
+
+  /**
+   * Pass a record to all appenders except source, regardless of the level.
+   * Used to replay recorded history.
+   */
+  virtual void forward(const LogRecord& record, const Appender* source) {
+  }
+
+  /**
+   * Called when the capture level of a registered appender changes
+   */
+  virtual void updateCaptureLevel() {
+  }
 };
 
 class Appender {
@@ -47,7 +72,60 @@ class Appender {
     unregister();
   }
 
-  virtual void append(const Level& level, const char* text) = 0;
+  /**
+   * Entry point of the logger, called once per message.
+   * The default encodes the record with encoding() and format()
+   * and passes the result to appendEncoded.
+   * Override this to consume the record directly without an intermediate string,
+   * i.e. for binary, batched or structured sinks.
+   */
+  virtual void append(const LogRecord& record) {
+    ScratchBuffer<Appender> buffer;
+    if (!Encoder::encode(m_encoding, buffer.str(), format(), record)) {
+      return;
+    }
+    if constexpr (METRICS_ENABLED) {
+      m_metrics.bytes.add(static_cast<std::uint32_t>(buffer.str().size()));
+    }
+    appendEncoded(record.level, buffer.str().c_str(), buffer.str().size());
+  }
+
+  /**
+   * Receives the encoded message including its size.
+   * The default forwards to append(level, text), which is sufficient
+   * for text and json. Appenders supporting CBOR have to override this
+   * as binary data may contain null bytes.
+   */
+  virtual void appendEncoded(const Level& level, const char* data, std::size_t size) {
+    append(level, data);
+  }
+
+  /**
+   * Receives the encoded message as null terminated string.
+   * Not called if append(const LogRecord&) or appendEncoded are overridden.
+   */
+  virtual void append(const Level& level, const char* text) {
+  }
+
+  /**
+   * Receives messages staged by one thread in logging order, see Logger::setStaging.
+   * Batches of different threads are never passed concurrently.
+   * The default passes each message to appendEncoded.
+   */
+  virtual void appendBatch(const LogBatch& batch) {
+    for (const auto& entry : batch) {
+      appendEncoded(entry.level, entry.data.data(), entry.data.size());
+    }
+  }
+
+  /**
+   * Staged messages are encoded with encoding() and format() on the logging thread.
+   * Appenders which override append(const LogRecord&) must return false,
+   * they are still called for every message.
+   */
+  [[nodiscard]] virtual bool supportsStaging() const {
+    return true;
+  }
 
   void unregister() {
     if (m_appenderId != AppenderIdNotSet) {
@@ -64,18 +142,72 @@ class Appender {
     m_format = format;
   }
 
+  [[nodiscard]] Encoding encoding() const {
+    return m_encoding;
+  }
+
+  /**
+   * Select the output encoding, TEXT uses format() to render the message
+   */
+  void setEncoding(Encoding encoding) {
+    m_encoding = encoding;
+  }
+
+  /**
+   * Lowest level received even if it is below Logger::level(), OFF by default.
+   * Appenders capturing below the level are called before all others,
+   * so history they replay precedes the record, i.e. the flight recorder.
+   */
+  [[nodiscard]] const Level& captureLevel() const {
+    return m_captureLevel;
+  }
+
+  /**
+   * Messages, encoded bytes and latency of append, updated by the logger
+   */
+  [[nodiscard]] const AppenderMetrics& metrics() const {
+    return m_metrics;
+  }
+
+  AppenderMetrics& metrics() {
+    return m_metrics;
+  }
+
  protected:
+  friend class Logger;
+
+  // serializes the calls of different threads while staging is enabled,
+  // recursive as an appender may log while it is called.
+  // Moving an appender does not move the lock state
+  class SinkMutex : public RecursiveMutex {
+   public:
+    SinkMutex() = default;
+    SinkMutex(SinkMutex&& /*other*/) noexcept {
+    }
+  };
+
+  void setCaptureLevel(const Level& level) {
+    m_captureLevel = level;
+    m_appenderStore->updateCaptureLevel();
+  }
+
   AppenderStorage* const m_appenderStore{};
   AppenderId m_appenderId{};
   std::string m_format;
+  Encoding m_encoding = Encoding::TEXT;
+  Level m_captureLevel = Level::OFF;
+  AppenderMetrics m_metrics;
+  SinkMutex m_sinkMutex;
 };
 
 class Logger : public AppenderStorage {
  public:
-  static constexpr const auto FORMAT_TIME = 't';
-  static constexpr const auto FORMAT_MSG = 'm';
-  static constexpr const auto FORMAT_CONTEXT = 'c';
-  static constexpr const auto FORMAT_LEVEL = 'l';
+  static constexpr const auto FORMAT_TIME = Encoder::FORMAT_TIME;
+  static constexpr const auto FORMAT_MSG = Encoder::FORMAT_MSG;
+  static constexpr const auto FORMAT_CONTEXT = Encoder::FORMAT_CONTEXT;
+  static constexpr const auto FORMAT_LEVEL = Encoder::FORMAT_LEVEL;
+  static constexpr const auto FORMAT_FIELDS = Encoder::FORMAT_FIELDS;
+  static constexpr const auto FORMAT_SOURCE = Encoder::FORMAT_SOURCE;
   static inline std::string DEFAULT_FORMAT = "[%t][%l][%c] %m";
 
   Logger() = default;
@@ -84,98 +216,189 @@ class Logger : public AppenderStorage {
   Logger(Logger&&) = default;
   void operator=(const Logger&) = delete;
 
+  [[nodiscard]] const std::string& context() const {
+    return m_context;
+  }
+
   // Impl of AppenderStorage
   [[nodiscard]] AppenderId addAppender(Appender* appender) override;
   void removeAppender(AppenderId appenderId) override;
+  void forward(const LogRecord& record, const Appender* source) override;
+  void updateCaptureLevel() override;
 
   static void setTimeFunc(TimeFunc&& func);
   static void setLevel(const Level& level);
   [[nodiscard]] static const Level& level();
 
-  void log(const Level& level, const char* text) const {
-    log(level, text, nullptr);
+  /**
+   * Lowest capture level of all registered appenders.
+   * Messages below level() but at or above it are only passed to the appenders
+   * capturing them, i.e. the flight recorder.
+   * OFF without such appenders, so nothing below level() is formatted.
+   */
+  [[nodiscard]] static const Level& captureLevel();
+
+  /**
+   * Preallocate the message and encoding buffers of the calling thread.
+   * Buffers keep their capacity, so logging messages up to this size
+   * does not allocate at all, see "Heap allocations" in the readme.
+   */
+  static void reserve(std::size_t size);
+
+  /**
+   * Counters of all loggers, can be read at any time without locking
+   */
+  [[nodiscard]] static const LoggerMetrics& metrics();
+  static void resetMetrics();
+
+  /**
+   * Rate limit and duplicate suppression applied to all loggers
+   * which have no limit of their own.
+   * Suppressed messages are reported with "last message repeated N times"
+   * before the next message of the same call site is logged, once the duplicate
+   * window has expired and a message is logged, or on flush().
+   */
+  static void setGlobalRateLimit(const RateLimit& limit);
+
+  /**
+   * Encode messages on the logging thread into a buffer per thread and appender,
+   * and hand them to the appender in batches of about batchSize bytes.
+   * Threads only contend on an appender once per batch instead of once per message.
+   * Each record gets a global sequence number to merge the output of different threads.
+   * Messages stay staged until the batch is full, a message at or above flushLevel
+   * is logged or flush() is called, so call flush() periodically
+   * and before destroying appenders.
+   * While staging is enabled appenders which are called directly are serialized
+   * as well, without staging every appender has to handle concurrent calls itself.
+   * Appenders are added and removed before threads start logging in either case.
+   * @param batchSize bytes per batch, 0 disables staging (default)
+   * @param flushLevel messages at or above this level hand off their batch immediately
+   */
+  static void setStaging(std::size_t batchSize, const Level& flushLevel = Level::ERROR);
+
+  /**
+   * Report pending rate limit summaries and
+   * hand the staged messages of all threads to the appenders
+   */
+  static void flush();
+
+  /**
+   * Rate limit for this logger context, overrides the global limit
+   */
+  void setRateLimit(const RateLimit& limit);
+  void resetRateLimit();
+  [[nodiscard]] const RateLimit& rateLimit() const;
+
+  void log(const Level& level, const Format& text) const {
+    log(level, Fields(), text);
   }
 
   template<typename T, typename... Targs>
-  void log(const Level& level, const char* format, T value, Targs... args) const {
+  void log(const Level& level, const Format& format, const T& value, const Targs&... args)
+    const {
+    log(level, Fields(), format, value, args...);
+  }
+
+  /**
+   * Log only if the sampler selects this occurrence.
+   * The sampler is checked first, so a skipped call costs an increment and compare.
+   */
+  template<
+    typename S,
+    typename... Targs,
+    typename = std::enable_if_t<std::is_base_of_v<Sampler, S>>>
+  void log(S& sampler, const Level& level, const Format& format, const Targs&... args)
+    const {
+    if (!sampler.sample()) {
+      return;
+    }
+    log(level, Fields(), format, args...);
+  }
+
+  /**
+   * Log a message with structured fields attached.
+   * The fields are rendered by the encoding of each appender,
+   * in text encoding they are only visible when the format contains %k.
+   */
+  template<typename... Targs>
+  void log(
+    const Level& level,
+    const Fields& fields,
+    const Format& format,
+    const Targs&... args) const {
     // discard message is level is turned off
     if (!levelEnabled(level)) {
+      reject(level);
       return;
     }
 
-    for (const auto& appenderPair : s_appender) {
-      std::stringstream ss;
-      const auto& appender = appenderPair.second;
-      const auto& appenderFormat = appender->format();
-      if (appenderFormat.empty()) {
-        continue;
-      }
-
-      for (auto i = 0U; i < appenderFormat.size(); ++i) {
-        const auto& currentChar = appenderFormat.at(i);
-        if (currentChar != '%' || i + 1 == appenderFormat.size()) {
-          ss << currentChar;
-          continue;
-        }
-
-        const auto& formatChar = appenderFormat.at(++i);
-        switch (formatChar) {
-          case FORMAT_MSG:
-            buildMessage(ss, format, value, args...);
-            break;
-          case FORMAT_TIME:
-            static constexpr const auto timeWidth = 20;
-            ss << std::setfill('0') << std::setw(timeWidth) << s_getTime();
-            break;
-          case FORMAT_LEVEL:
-            ss << level.str();
-            break;
-          case FORMAT_CONTEXT:
-            if (!m_context.empty()) {
-              ss << m_context;
-            }
-            break;
-          default:
-            ss << "%" << formatChar;
-            break;
-        }
-      }
-      appender->append(level, ss.str().c_str());
-    }
+    const std::array<Argument, sizeof...(Targs)> arguments{args...};
+    logArguments(level, fields, format, Arguments(arguments.data(), arguments.size()));
   }
 
  private:
   [[nodiscard]] static bool levelEnabled(const Level& level) {
-    return level >= s_level && level <= Level::OFF;
+    return (level >= s_level || level >= s_captureLevel) && level <= Level::OFF;
   }
 
-  template<typename T, typename... Targs>
-  void buildMessage(std::stringstream& ss, const char* format, T value, Targs... args)
-    const {
-    for (; *format != '\0'; ++format) {
-      if (*format == '%') {
-        ss << value;
-        buildMessage(ss, format + 1, args...);  // recursive call
-        return;
-      }
-      ss << *format;
+  static void reject(const Level& level) {
+    if constexpr (METRICS_ENABLED) {
+      s_metrics.rejected.at(static_cast<unsigned int>(level)).add();
     }
   }
 
+  /**
+   * Formatting core shared by all call sites, independent of the argument types
+   */
+  void logArguments(
+    const Level& level,
+    const Fields& fields,
+    const Format& format,
+    const Arguments& arguments) const;
+
   static void buildMessage(
-    std::stringstream& stream,
-    const char* format)  // base function
-  {
-    if (format != nullptr && *format != '\0') {
-      stream << *format;
-    }
-  }
+    std::string& out,
+    const char* format,
+    const Arguments& arguments);
+
+  static void dispatch(
+    const std::string& context,
+    const Level& level,
+    const Fields& fields,
+    const SourceLocation& location,
+    const std::string& message);
+
+  [[nodiscard]] bool rateLimitAllows(const Level& level, const Format& format) const;
+  static void dispatchSummaries(bool all);
+
+  struct Stage;
+  struct StageRegistry;
+  static Stage& stage();
+  static StageRegistry& stageRegistry();
+  static std::uint64_t nextSequence();
+  static bool& handingOff();
+  static void stage(
+    Appender& appender,
+    const LogRecord& record,
+    std::size_t batchSize,
+    bool handOffWhenFull = true);
+  static void handOff(Appender& appender, std::string& batch, std::size_t& size);
+  static void appendDirect(Appender& appender, const LogRecord& record);
+  static void discardStaged(const Appender* appender);
+
   static inline Level s_defaultLevel = Level::DEBUG;
   static inline TimeFunc s_getTime = []() { return std::to_string(millis()); };
   static inline std::map<AppenderId, Appender*> s_appender;
   static inline Level s_level = s_defaultLevel;
+  static inline Level s_captureLevel = Level::OFF;
+  static inline RateLimit s_rateLimit;
+  static inline RateLimiter s_rateLimiter;
+  static inline LoggerMetrics s_metrics;
+  static inline Counter s_stagingSize;
+  static inline Level s_stagingFlushLevel = Level::ERROR;
 
   std::string m_context = "default";
+  std::optional<RateLimit> m_rateLimit;
 };
 
 }  // namespace yal
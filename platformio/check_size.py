@@ -0,0 +1,47 @@
+#
+# Copyright (c) 2022 Alexander Mohr
+# Licensed under the terms of the MIT License
+#
+
+# Fails the firmware build if the code sections grew beyond text_size_budget.txt.
+# Set YAL_UPDATE_SIZE_BUDGET=1 to store the current size as new budget,
+# the build fails while the budget file is missing.
+
+import os
+import re
+import subprocess
+
+Import("env")
+
+BUDGET_FILE = os.path.join(env.subst("$PROJECT_DIR"), "text_size_budget.txt")
+
+
+def text_size(elf):
+    output = subprocess.check_output([env.subst("$SIZETOOL"), "-A", elf], text=True)
+    # .text is in iram, .irom0.text in flash on the esp8266
+    return sum(int(size) for size in re.findall(r"^\S*\.text\s+(\d+)", output, re.MULTILINE))
+
+
+def check_text_size(source, target, env):
+    size = text_size(str(target[0]))
+    if os.environ.get("YAL_UPDATE_SIZE_BUDGET"):
+        with open(BUDGET_FILE, "w") as budget_file:
+            budget_file.write("%d\n" % size)
+        print("text size %d bytes stored as budget in %s" % (size, BUDGET_FILE))
+        return
+
+    # a missing budget must not pass silently, it has to be created deliberately
+    if not os.path.exists(BUDGET_FILE):
+        print("text size %d bytes, %s is missing" % (size, BUDGET_FILE))
+        print("run the build with YAL_UPDATE_SIZE_BUDGET=1 and commit the budget")
+        env.Exit(1)
+
+    with open(BUDGET_FILE) as budget_file:
+        budget = int(budget_file.read())
+    print("text size %d bytes, budget %d bytes" % (size, budget))
+    if size > budget:
+        print("text size exceeds the budget by %d bytes" % (size - budget))
+        env.Exit(1)
+
+
+env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", check_text_size)
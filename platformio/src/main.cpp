@@ -30,6 +30,16 @@ void setup() {
   m_logger.log(yal::Level::WARNING, "setup test");
   m_logger.log(yal::Level::ERROR, "setup test");
   m_logger.log(yal::Level::FATAL, "setup test");
+  m_logger.log(
+    yal::Level::INFO,
+    "free heap % bytes, chip id %",
+    ESP.getFreeHeap(),
+    ESP.getChipId());
+  m_logger.log(
+    yal::Level::INFO,
+    "sdk % reset reason %",
+    ESP.getSdkVersion(),
+    ESP.getResetReason().c_str());
 
   m_mqttAppender.registerChangeLevelTopic("/log/level");
 
@@ -46,6 +56,11 @@ void loop() {
   m_logger.log(yal::Level::WARNING, "loop test");
   m_logger.log(yal::Level::ERROR, "loop test");
   m_logger.log(yal::Level::FATAL, "loop test");
+  m_logger.log(
+    yal::Level::DEBUG,
+    "uptime % ms, connected %",
+    millis(),
+    m_mqttClient.connected());
 
   // remember to flush the appender when it's safe to do so
   // Do NOT call this while in an ISR
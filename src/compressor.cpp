@@ -0,0 +1,237 @@
+//
+// Copyright (c) 2022 Alexander Mohr
+// Licensed under the terms of the MIT License
+//
+
+#include <yal/Compressor.hpp>
+#include <yal/Encoder.hpp>
+#include <yal/LogRecord.hpp>
+#include <algorithm>
+#include <cstring>
+
+namespace yal {
+
+namespace {
+constexpr const unsigned TOKEN_BITS = 16;
+constexpr const unsigned FLAG_BITS = 8;
+constexpr const std::size_t MIN_MATCH = 3;
+// candidates compared per byte, longer chains find longer matches but take longer
+constexpr const unsigned MAX_CHAIN = 16;
+// offsets which are not indexed yet, the positions behind them lack 3 known bytes
+constexpr const std::size_t UNINDEXED_OFFSETS = MIN_MATCH - 1;
+
+constexpr unsigned lengthBits(unsigned windowBits) {
+  return TOKEN_BITS - windowBits;
+}
+
+constexpr std::size_t maxMatch(unsigned windowBits) {
+  return MIN_MATCH + (std::size_t{1} << lengthBits(windowBits)) - 1;
+}
+
+static_assert(
+  YAL_COMPRESSION_WINDOW_BITS >= 8 && YAL_COMPRESSION_WINDOW_BITS <= 12,
+  "window bits must leave room for the match length");
+}  // namespace
+
+Compressor::Compressor(std::string_view dictionary) :
+    m_window(std::make_unique<char[]>(WINDOW_SIZE)),
+    m_head(std::make_unique<std::uint16_t[]>(HASH_SIZE)),
+    m_chain(std::make_unique<std::uint16_t[]>(WINDOW_SIZE)),
+    m_dictionary(tail(dictionary, WINDOW_SIZE)) {
+}
+
+std::string_view Compressor::tail(std::string_view dictionary, std::size_t size) {
+  return dictionary.substr(dictionary.size() - std::min(dictionary.size(), size));
+}
+
+void Compressor::begin(std::string& out) {
+  // the window starts with zeros followed by the dictionary,
+  // positions start at the window size so all offsets are valid
+  std::memset(m_window.get(), 0, WINDOW_SIZE);
+  m_position = WINDOW_SIZE;
+  // points just before the window, offsets beyond the window end a chain
+  std::fill_n(
+    m_head.get(), HASH_SIZE, static_cast<std::uint16_t>(m_position - WINDOW_SIZE - 1));
+  for (const auto value : m_dictionary) {
+    push(value);
+  }
+
+  out += static_cast<char>(WINDOW_BITS);
+  m_flagBit = FLAG_BITS;
+}
+
+void Compressor::write(std::string& out, const char* const data, const std::size_t size) {
+  constexpr const auto mask = WINDOW_SIZE - 1;
+  auto index = std::size_t{0};
+  while (index < size) {
+    const auto longest = std::min(maxMatch(WINDOW_BITS), size - index);
+    std::size_t bestLength = 0;
+    std::size_t bestOffset = 0;
+    // bytes behind the window end are taken from the input, so matches may overlap it
+    const auto at = [&](std::size_t position) {
+      return position < m_position ? m_window[position & mask]
+                                   : data[index + position - m_position];
+    };
+
+    const auto compare = [&](std::size_t offset) {
+      const auto start = m_position - offset;
+      auto length = std::size_t{0};
+      while (length < longest && at(start + length) == data[index + length]) {
+        ++length;
+      }
+      if (length > bestLength) {
+        bestLength = length;
+        bestOffset = offset;
+      }
+      return length == longest;
+    };
+
+    if (longest >= MIN_MATCH) {
+      auto found = false;
+      for (auto offset = std::size_t{1}; offset <= UNINDEXED_OFFSETS && !found; ++offset)
+      {
+        found = compare(offset);
+      }
+
+      auto candidate = m_head[hash(data[index], data[index + 1], data[index + 2])];
+      auto previous = std::size_t{0};
+      for (auto step = 0U; !found && step < MAX_CHAIN; ++step) {
+        const std::size_t offset = static_cast<std::uint16_t>(m_position - candidate);
+        // offsets grow along a chain, anything else is a stale entry
+        if (offset <= previous || offset > WINDOW_SIZE) {
+          break;
+        }
+        found = compare(offset);
+        previous = offset;
+        candidate = m_chain[candidate & mask];
+      }
+    }
+
+    if (bestLength >= MIN_MATCH) {
+      emitMatch(out, bestOffset, bestLength);
+    } else {
+      bestLength = 1;
+      emitLiteral(out, data[index]);
+    }
+    for (auto i = std::size_t{0}; i < bestLength; ++i) {
+      push(data[index + i]);
+    }
+    index += bestLength;
+  }
+}
+
+bool Compressor::decompress(
+  std::string_view payload,
+  std::string_view dictionary,
+  std::string& out) {
+  if (payload.empty()) {
+    return false;
+  }
+  const auto windowBits = static_cast<std::uint8_t>(payload.front());
+  if (windowBits < 8 || windowBits > 12) {
+    return false;
+  }
+  payload.remove_prefix(1);
+
+  const auto windowSize = std::size_t{1} << windowBits;
+  dictionary = tail(dictionary, windowSize);
+  std::string buffer(windowSize, '\0');
+  buffer.append(dictionary);
+  const auto start = buffer.size();
+
+  const auto lengthMask = (1U << lengthBits(windowBits)) - 1;
+  while (!payload.empty()) {
+    const auto flags = static_cast<std::uint8_t>(payload.front());
+    payload.remove_prefix(1);
+    for (auto bit = 0U; bit < FLAG_BITS && !payload.empty(); ++bit) {
+      if ((flags & (1U << bit)) != 0) {
+        buffer += payload.front();
+        payload.remove_prefix(1);
+        continue;
+      }
+
+      if (payload.size() < 2) {
+        return false;
+      }
+      const auto high = static_cast<std::uint8_t>(payload[0]);
+      const auto low = static_cast<std::uint8_t>(payload[1]);
+      const auto token = static_cast<unsigned>(high << 8U | low);
+      payload.remove_prefix(2);
+      const auto offset = (token >> lengthBits(windowBits)) + 1;
+      const auto length = (token & lengthMask) + MIN_MATCH;
+      // byte by byte, the match may overlap the bytes it produces
+      for (auto i = std::size_t{0}; i < length; ++i) {
+        buffer += buffer[buffer.size() - offset];
+      }
+    }
+  }
+
+  out.append(buffer, start, std::string::npos);
+  return true;
+}
+
+std::string Compressor::dictionary(
+  const std::string& format,
+  std::initializer_list<std::string_view> contexts) {
+  std::string dictionary;
+  for (const auto context : contexts) {
+    for (auto level = 0; level < static_cast<int>(Level::OFF); ++level) {
+      const LogRecord record{
+        static_cast<Level::Value>(level), 0, "0", context, "", {}, {}};
+      Encoder::encodeText(dictionary, format, record);
+      dictionary += '\n';
+    }
+  }
+  return dictionary;
+}
+
+void Compressor::emitLiteral(std::string& out, const char value) {
+  nextFlag(out);
+  out[m_flagOffset] = static_cast<char>(
+    static_cast<std::uint8_t>(out[m_flagOffset]) | (1U << (m_flagBit - 1)));
+  out += value;
+}
+
+void Compressor::emitMatch(
+  std::string& out,
+  const std::size_t offset,
+  const std::size_t length) {
+  nextFlag(out);
+  const auto token = static_cast<unsigned>(
+    (offset - 1) << lengthBits(WINDOW_BITS) | (length - MIN_MATCH));
+  out += static_cast<char>(token >> 8U);
+  out += static_cast<char>(token & 0xffU);
+}
+
+void Compressor::nextFlag(std::string& out) {
+  if (m_flagBit == FLAG_BITS) {
+    m_flagOffset = out.size();
+    out += '\0';
+    m_flagBit = 0;
+  }
+  ++m_flagBit;
+}
+
+void Compressor::push(const char value) {
+  constexpr const auto mask = WINDOW_SIZE - 1;
+  m_window[m_position & mask] = value;
+  ++m_position;
+
+  // the position MIN_MATCH bytes back has all of its bytes now
+  const auto position = m_position - MIN_MATCH;
+  auto& head = m_head[hash(
+    m_window[position & mask],
+    m_window[(position + 1) & mask],
+    m_window[(position + 2) & mask])];
+  m_chain[position & mask] = head;
+  head = static_cast<std::uint16_t>(position);
+}
+
+std::size_t Compressor::hash(const char first, const char second, const char third) {
+  const auto key = static_cast<std::uint8_t>(first) << 6U
+                   ^ static_cast<std::uint8_t>(second) << 3U
+                   ^ static_cast<std::uint8_t>(third);
+  return key & (HASH_SIZE - 1);
+}
+
+}  // namespace yal
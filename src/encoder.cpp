@@ -0,0 +1,308 @@
+//
+// Copyright (c) 2022 Alexander Mohr
+// Licensed under the terms of the MIT License
+//
+
+#include <yal/Encoder.hpp>
+#include <yal/Formatter.hpp>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace yal {
+
+namespace {
+constexpr const auto TIME_WIDTH = 20U;
+
+// CBOR major types, see RFC 8949
+constexpr const std::uint8_t CBOR_UINT = 0;
+constexpr const std::uint8_t CBOR_NEGATIVE = 1;
+constexpr const std::uint8_t CBOR_TEXT = 3;
+constexpr const std::uint8_t CBOR_MAP = 5;
+constexpr const std::uint8_t CBOR_FALSE = 0xf4;
+constexpr const std::uint8_t CBOR_TRUE = 0xf5;
+constexpr const std::uint8_t CBOR_DOUBLE = 0xfb;
+constexpr const auto CBOR_HEADER_FIELDS = 4U;
+}  // namespace
+
+bool Encoder::encode(
+  const Encoding encoding,
+  std::string& out,
+  const std::string& format,
+  const LogRecord& record) {
+  switch (encoding) {
+    case Encoding::JSON:
+      encodeJson(out, record);
+      return true;
+    case Encoding::CBOR:
+      encodeCbor(out, record);
+      return true;
+    case Encoding::TEXT:
+    default:
+      return encodeText(out, format, record);
+  }
+}
+
+bool Encoder::encodeText(
+  std::string& out,
+  const std::string& format,
+  const LogRecord& record) {
+  if (format.empty()) {
+    return false;
+  }
+
+  for (auto i = 0U; i < format.size(); ++i) {
+    const auto& currentChar = format[i];
+    if (currentChar != '%' || i + 1 == format.size()) {
+      out += currentChar;
+      continue;
+    }
+
+    const auto& formatChar = format[++i];
+    switch (formatChar) {
+      case FORMAT_MSG:
+        out.append(record.message);
+        break;
+      case FORMAT_TIME:
+        if (record.time.size() < TIME_WIDTH) {
+          out.append(TIME_WIDTH - record.time.size(), '0');
+        }
+        out.append(record.time);
+        break;
+      case FORMAT_LEVEL:
+        out.append(record.level.str());
+        break;
+      case FORMAT_CONTEXT:
+        out.append(record.context);
+        break;
+      case FORMAT_FIELDS:
+        for (const auto& field : record.fields) {
+          if (&field != record.fields.begin()) {
+            out += ' ';
+          }
+          writeFieldText(out, field);
+        }
+        break;
+      case FORMAT_SOURCE:
+        out.append(record.location.file);
+        out += ':';
+        Formatter::writeUnsigned(out, record.location.line);
+        break;
+      default:
+        out += '%';
+        out += formatChar;
+        break;
+    }
+  }
+  return true;
+}
+
+void Encoder::encodeJson(std::string& out, const LogRecord& record) {
+  out += "{\"";
+  out += KEY_TIME;
+  out += "\":";
+  writeJsonString(out, record.time);
+  out += ",\"";
+  out += KEY_LEVEL;
+  out += "\":";
+  writeJsonString(out, levelName(record.level));
+  out += ",\"";
+  out += KEY_CONTEXT;
+  out += "\":";
+  writeJsonString(out, record.context);
+  out += ",\"";
+  out += KEY_MSG;
+  out += "\":";
+  writeJsonString(out, record.message);
+  for (const auto& field : record.fields) {
+    out += ',';
+    writeJsonString(out, field.key());
+    out += ':';
+    writeJsonValue(out, field);
+  }
+  out += '}';
+}
+
+void Encoder::encodeCbor(std::string& out, const LogRecord& record) {
+  writeCborHead(out, CBOR_MAP, CBOR_HEADER_FIELDS + record.fields.size());
+  writeCborString(out, KEY_TIME);
+  writeCborString(out, record.time);
+  writeCborString(out, KEY_LEVEL);
+  writeCborString(out, levelName(record.level));
+  writeCborString(out, KEY_CONTEXT);
+  writeCborString(out, record.context);
+  writeCborString(out, KEY_MSG);
+  writeCborString(out, record.message);
+  for (const auto& field : record.fields) {
+    writeCborString(out, field.key());
+    writeCborValue(out, field);
+  }
+}
+
+void Encoder::writeFieldText(std::string& out, const Field& field) {
+  out.append(field.key());
+  out += '=';
+  switch (field.type()) {
+    case Field::Type::BOOL:
+      out.append(field.asBool() ? "true" : "false");
+      break;
+    case Field::Type::INT:
+      Formatter::writeInteger(out, field.asInt());
+      break;
+    case Field::Type::UINT:
+      Formatter::writeUnsigned(out, field.asUInt());
+      break;
+    case Field::Type::DOUBLE:
+      Formatter::writeDouble(out, field.asDouble());
+      break;
+    case Field::Type::STRING:
+      out.append(field.asString());
+      break;
+  }
+}
+
+void Encoder::writeJsonString(std::string& out, const std::string_view text) {
+  static constexpr const char* const hex = "0123456789abcdef";
+  static constexpr const auto controlCharLimit = 0x20U;
+  static constexpr const auto nibbleBits = 4U;
+  static constexpr const auto nibbleMask = 0xfU;
+
+  out += '"';
+  for (const auto c : text) {
+    switch (c) {
+      case '"':
+        out += "\\\"";
+        break;
+      case '\\':
+        out += "\\\\";
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      case '\r':
+        out += "\\r";
+        break;
+      case '\t':
+        out += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < controlCharLimit) {
+          out += "\\u00";
+          out += hex[static_cast<unsigned char>(c) >> nibbleBits];
+          out += hex[static_cast<unsigned char>(c) & nibbleMask];
+        } else {
+          out += c;
+        }
+        break;
+    }
+  }
+  out += '"';
+}
+
+void Encoder::writeJsonValue(std::string& out, const Field& field) {
+  switch (field.type()) {
+    case Field::Type::BOOL:
+      out.append(field.asBool() ? "true" : "false");
+      break;
+    case Field::Type::INT:
+      Formatter::writeInteger(out, field.asInt());
+      break;
+    case Field::Type::UINT:
+      Formatter::writeUnsigned(out, field.asUInt());
+      break;
+    case Field::Type::DOUBLE:
+      // JSON has no representation for nan and inf
+      if (std::isfinite(field.asDouble())) {
+        Formatter::writeDouble(out, field.asDouble());
+      } else {
+        out.append("null");
+      }
+      break;
+    case Field::Type::STRING:
+      writeJsonString(out, field.asString());
+      break;
+  }
+}
+
+void Encoder::writeCborHead(
+  std::string& out,
+  const std::uint8_t major,
+  const std::uint64_t value) {
+  static constexpr const std::uint8_t majorShift = 5;
+  static constexpr const std::uint8_t maxInline = 23;
+  static constexpr const std::uint8_t follows8Bit = 24;
+  static constexpr const std::uint8_t follows16Bit = 25;
+  static constexpr const std::uint8_t follows32Bit = 26;
+  static constexpr const std::uint8_t follows64Bit = 27;
+  static constexpr const auto byteBits = 8U;
+
+  const auto type = static_cast<std::uint8_t>(major << majorShift);
+  auto writeBigEndian = [&](const std::uint8_t additional, const unsigned int bytes) {
+    out += static_cast<char>(type | additional);
+    for (auto i = bytes; i > 0; --i) {
+      out += static_cast<char>((value >> ((i - 1) * byteBits)) & 0xffU);
+    }
+  };
+
+  if (value <= maxInline) {
+    out += static_cast<char>(type | value);
+  } else if (value <= std::numeric_limits<std::uint8_t>::max()) {
+    writeBigEndian(follows8Bit, sizeof(std::uint8_t));
+  } else if (value <= std::numeric_limits<std::uint16_t>::max()) {
+    writeBigEndian(follows16Bit, sizeof(std::uint16_t));
+  } else if (value <= std::numeric_limits<std::uint32_t>::max()) {
+    writeBigEndian(follows32Bit, sizeof(std::uint32_t));
+  } else {
+    writeBigEndian(follows64Bit, sizeof(std::uint64_t));
+  }
+}
+
+void Encoder::writeCborString(std::string& out, const std::string_view text) {
+  writeCborHead(out, CBOR_TEXT, text.size());
+  out.append(text);
+}
+
+void Encoder::writeCborValue(std::string& out, const Field& field) {
+  static constexpr const auto byteBits = 8U;
+  switch (field.type()) {
+    case Field::Type::BOOL:
+      out += static_cast<char>(field.asBool() ? CBOR_TRUE : CBOR_FALSE);
+      break;
+    case Field::Type::INT:
+      if (field.asInt() < 0) {
+        // negative integers are encoded as -1 - n
+        writeCborHead(
+          out, CBOR_NEGATIVE, static_cast<std::uint64_t>(-(field.asInt() + 1)));
+      } else {
+        writeCborHead(out, CBOR_UINT, static_cast<std::uint64_t>(field.asInt()));
+      }
+      break;
+    case Field::Type::UINT:
+      writeCborHead(out, CBOR_UINT, field.asUInt());
+      break;
+    case Field::Type::DOUBLE: {
+      const auto value = field.asDouble();
+      std::uint64_t bits = 0;
+      std::memcpy(&bits, &value, sizeof(bits));
+      out += static_cast<char>(CBOR_DOUBLE);
+      for (auto i = sizeof(bits); i > 0; --i) {
+        out += static_cast<char>((bits >> ((i - 1) * byteBits)) & 0xffU);
+      }
+      break;
+    }
+    case Field::Type::STRING:
+      writeCborString(out, field.asString());
+      break;
+  }
+}
+
+std::string_view Encoder::levelName(const Level& level) {
+  // level names are padded for text output, structured output is trimmed
+  std::string_view name = level.str();
+  while (!name.empty() && name.back() == ' ') {
+    name.remove_suffix(1);
+  }
+  return name;
+}
+
+}  // namespace yal
@@ -0,0 +1,420 @@
+//
+// Copyright (c) 2022 Alexander Mohr
+// Licensed under the terms of the MIT License
+//
+
+#include <yal/appender/FlightRecorder.hpp>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <string_view>
+#include <vector>
+
+#if defined(__linux__) && !(HAVE_ARDUINO || YAL_ARDUINO_SUPPORT)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace yal::appender {
+
+namespace {
+// layout of a recorded message, all values in native byte order:
+// u16 entry size | u8 level and flags | u32 timestamp
+// u8 time length | time | u8 context length | context
+// u16 message length | message | u8 field count | fields
+// each field is stored as
+// u8 key length | key | '\0' | u8 type | value (u8, 8 bytes or u16 length + string)
+using EntrySize = std::uint16_t;
+using ShortLength = std::uint8_t;
+using LongLength = std::uint16_t;
+
+constexpr const std::uint8_t FLAG_DELIVERED = 0x80;
+constexpr const std::uint8_t LEVEL_MASK = 0x7f;
+constexpr const std::size_t MAX_SHORT = std::numeric_limits<ShortLength>::max();
+constexpr const std::size_t MAX_LONG = std::numeric_limits<LongLength>::max();
+constexpr const std::size_t MAX_ENTRY = std::numeric_limits<EntrySize>::max();
+constexpr const std::size_t ENTRY_FIXED_SIZE =
+  sizeof(EntrySize) + sizeof(std::uint8_t) + sizeof(std::uint32_t) + sizeof(ShortLength)
+  + sizeof(ShortLength) + sizeof(LongLength) + sizeof(std::uint8_t);
+constexpr const std::size_t FIELD_VALUE_SIZE = sizeof(std::uint64_t);
+
+std::size_t fieldSize(const Field& field) {
+  const auto keyLength = std::min(std::strlen(field.key()), MAX_SHORT);
+  auto size = sizeof(ShortLength) + keyLength + 1 + sizeof(std::uint8_t);
+  switch (field.type()) {
+    case Field::Type::BOOL:
+      return size + sizeof(std::uint8_t);
+    case Field::Type::STRING:
+      return size + sizeof(LongLength) + std::min(field.asString().size(), MAX_LONG);
+    default:
+      return size + FIELD_VALUE_SIZE;
+  }
+}
+template<typename T>
+bool take(std::string_view& in, T& value) {
+  if (in.size() < sizeof(value)) {
+    return false;
+  }
+  std::memcpy(&value, in.data(), sizeof(value));
+  in.remove_prefix(sizeof(value));
+  return true;
+}
+
+template<typename Length>
+bool takeString(std::string_view& in, std::string_view& value) {
+  Length length = 0;
+  if (!take(in, length) || in.size() < length) {
+    return false;
+  }
+  value = in.substr(0, length);
+  in.remove_prefix(length);
+  return true;
+}
+
+bool takeField(std::string_view& in, std::vector<Field>& fields) {
+  ShortLength keyLength = 0;
+  std::uint8_t type = 0;
+  // the key is passed on as a C string, so its terminator has to be present
+  if (!take(in, keyLength) || in.size() <= keyLength || in[keyLength] != '\0') {
+    return false;
+  }
+  const auto* const key = in.data();
+  in.remove_prefix(keyLength + 1);
+  if (!take(in, type)) {
+    return false;
+  }
+
+  switch (static_cast<Field::Type>(type)) {
+    case Field::Type::BOOL: {
+      std::uint8_t value = 0;
+      if (!take(in, value)) {
+        return false;
+      }
+      fields.emplace_back(key, value != 0);
+      return true;
+    }
+    case Field::Type::INT: {
+      std::int64_t value = 0;
+      if (!take(in, value)) {
+        return false;
+      }
+      fields.emplace_back(key, value);
+      return true;
+    }
+    case Field::Type::UINT: {
+      std::uint64_t value = 0;
+      if (!take(in, value)) {
+        return false;
+      }
+      fields.emplace_back(key, value);
+      return true;
+    }
+    case Field::Type::DOUBLE: {
+      double value = 0;
+      if (!take(in, value)) {
+        return false;
+      }
+      fields.emplace_back(key, value);
+      return true;
+    }
+    case Field::Type::STRING: {
+      std::string_view value;
+      if (!takeString<LongLength>(in, value)) {
+        return false;
+      }
+      fields.emplace_back(key, value);
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace
+
+FlightRecorder::FlightRecorder(
+  AppenderStorage* storage,
+  const std::size_t capacity,
+  const Level& captureLevel,
+  const Level& dumpLevel) :
+    Appender(storage, ""), m_dumpLevel(dumpLevel) {
+  m_memory = std::make_unique<std::uint8_t[]>(sizeof(Header) + capacity);
+  init(m_memory.get(), capacity, false);
+  setCaptureLevel(captureLevel);
+}
+
+#if defined(__linux__) && !(HAVE_ARDUINO || YAL_ARDUINO_SUPPORT)
+FlightRecorder::FlightRecorder(
+  AppenderStorage* storage,
+  const std::size_t capacity,
+  const char* path,
+  const Level& captureLevel,
+  const Level& dumpLevel) :
+    Appender(storage, ""), m_dumpLevel(dumpLevel) {
+  const auto mappingSize = sizeof(Header) + capacity;
+  const auto fd = open(path, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR | S_IRGRP);
+  struct stat fileStat {};
+  if (fd >= 0 && fstat(fd, &fileStat) == 0
+      && ftruncate(fd, static_cast<off_t>(mappingSize)) == 0)
+  {
+    auto* const mapping =
+      mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping != MAP_FAILED) {
+      m_mapping = mapping;
+      m_mappingSize = mappingSize;
+    }
+  }
+  if (fd >= 0) {
+    close(fd);
+  }
+
+  if (m_mapping != nullptr) {
+    const auto existing = static_cast<std::size_t>(fileStat.st_size) == mappingSize;
+    init(static_cast<std::uint8_t*>(m_mapping), capacity, existing);
+  } else {
+    m_memory = std::make_unique<std::uint8_t[]>(mappingSize);
+    init(m_memory.get(), capacity, false);
+  }
+  setCaptureLevel(captureLevel);
+}
+#endif
+
+FlightRecorder::~FlightRecorder() {
+#if defined(__linux__) && !(HAVE_ARDUINO || YAL_ARDUINO_SUPPORT)
+  if (m_mapping != nullptr) {
+    munmap(m_mapping, m_mappingSize);
+  }
+#endif
+}
+
+void FlightRecorder::init(
+  std::uint8_t* memory,
+  const std::size_t capacity,
+  const bool keepContent) {
+  m_header = reinterpret_cast<Header*>(memory);
+  m_data = memory + sizeof(Header);
+
+  const auto valid = keepContent && m_header->magic == MAGIC
+                     && m_header->capacity == capacity && m_header->head < capacity
+                     && m_header->size <= capacity;
+  if (!valid) {
+    m_header->magic = MAGIC;
+    m_header->capacity = static_cast<std::uint32_t>(capacity);
+    clear();
+  }
+}
+
+void FlightRecorder::append(const LogRecord& record) {
+  if (m_replaying) {
+    return;
+  }
+
+  const auto time = record.time.substr(0, MAX_SHORT);
+  const auto context = record.context.substr(0, MAX_SHORT);
+  const auto fieldCount = std::min(record.fields.size(), MAX_SHORT);
+
+  auto fieldsSize = 0U;
+  for (auto i = 0U; i < fieldCount; ++i) {
+    fieldsSize += fieldSize(*(record.fields.begin() + i));
+  }
+
+  const auto limit = std::min(static_cast<std::size_t>(m_header->capacity), MAX_ENTRY);
+  const auto fixedSize = ENTRY_FIXED_SIZE + time.size() + context.size() + fieldsSize;
+  if (fixedSize >= limit) {
+    return;
+  }
+  // truncate the message to fit into the buffer
+  const auto message = record.message.substr(0, std::min(limit - fixedSize, MAX_LONG));
+  const auto entrySize = static_cast<EntrySize>(fixedSize + message.size());
+
+  while (m_header->capacity - m_header->size < entrySize) {
+    dropOldest();
+  }
+
+  auto flags = static_cast<std::uint8_t>(record.level.value());
+  if (record.level >= Logger::level()) {
+    flags |= FLAG_DELIVERED;
+  }
+  const auto timestamp = static_cast<std::uint32_t>(record.timestamp);
+  const auto timeLength = static_cast<ShortLength>(time.size());
+  const auto contextLength = static_cast<ShortLength>(context.size());
+  const auto messageLength = static_cast<LongLength>(message.size());
+  const auto fieldCountValue = static_cast<std::uint8_t>(fieldCount);
+
+  // the size is committed after the complete entry has been written,
+  // so a crash while writing never leaves a partial entry behind
+  auto offset = static_cast<std::size_t>(m_header->size);
+  write(offset, &entrySize, sizeof(entrySize));
+  write(offset, &flags, sizeof(flags));
+  write(offset, &timestamp, sizeof(timestamp));
+  write(offset, &timeLength, sizeof(timeLength));
+  write(offset, time.data(), time.size());
+  write(offset, &contextLength, sizeof(contextLength));
+  write(offset, context.data(), context.size());
+  write(offset, &messageLength, sizeof(messageLength));
+  write(offset, message.data(), message.size());
+  write(offset, &fieldCountValue, sizeof(fieldCountValue));
+
+  for (auto i = 0U; i < fieldCount; ++i) {
+    const auto& field = *(record.fields.begin() + i);
+    const auto keyLength =
+      static_cast<ShortLength>(std::min(std::strlen(field.key()), MAX_SHORT));
+    const auto type = static_cast<std::uint8_t>(field.type());
+    const char terminator = '\0';
+    write(offset, &keyLength, sizeof(keyLength));
+    write(offset, field.key(), keyLength);
+    write(offset, &terminator, sizeof(terminator));
+    write(offset, &type, sizeof(type));
+    switch (field.type()) {
+      case Field::Type::BOOL: {
+        const auto value = static_cast<std::uint8_t>(field.asBool());
+        write(offset, &value, sizeof(value));
+        break;
+      }
+      case Field::Type::INT: {
+        const auto value = field.asInt();
+        write(offset, &value, sizeof(value));
+        break;
+      }
+      case Field::Type::UINT: {
+        const auto value = field.asUInt();
+        write(offset, &value, sizeof(value));
+        break;
+      }
+      case Field::Type::DOUBLE: {
+        const auto value = field.asDouble();
+        write(offset, &value, sizeof(value));
+        break;
+      }
+      case Field::Type::STRING: {
+        const auto value = field.asString().substr(0, MAX_LONG);
+        const auto length = static_cast<LongLength>(value.size());
+        write(offset, &length, sizeof(length));
+        write(offset, value.data(), value.size());
+        break;
+      }
+    }
+  }
+
+  m_header->size += entrySize;
+
+  if (record.level >= m_dumpLevel) {
+    dump();
+  }
+}
+
+void FlightRecorder::dump() {
+  replay(false);
+}
+
+void FlightRecorder::dumpAll() {
+  replay(true);
+}
+
+void FlightRecorder::clear() {
+  m_header->head = 0;
+  m_header->size = 0;
+}
+
+std::size_t FlightRecorder::size() const {
+  return m_header->size;
+}
+
+std::size_t FlightRecorder::capacity() const {
+  return m_header->capacity;
+}
+
+void FlightRecorder::replay(const bool all) {
+  m_replaying = true;
+  std::vector<Field> fields;
+
+  std::size_t offset = 0;
+  while (offset < m_header->size) {
+    EntrySize entrySize = 0;
+    read(offset, &entrySize, sizeof(entrySize));
+    // stop at corrupted entries, i.e. of a recovered file
+    if (entrySize < ENTRY_FIXED_SIZE || offset + entrySize > m_header->size) {
+      break;
+    }
+    m_scratch.resize(entrySize);
+    read(offset, m_scratch.data(), entrySize);
+    offset += entrySize;
+
+    std::string_view entry(m_scratch.data(), m_scratch.size());
+    entry.remove_prefix(sizeof(EntrySize));
+    std::uint8_t flags = 0;
+    std::uint32_t timestamp = 0;
+    std::string_view time;
+    std::string_view context;
+    std::string_view message;
+    std::uint8_t fieldCount = 0;
+    auto valid = take(entry, flags) && (flags & LEVEL_MASK) < Level::OFF
+                 && take(entry, timestamp) && takeString<ShortLength>(entry, time)
+                 && takeString<ShortLength>(entry, context)
+                 && takeString<LongLength>(entry, message) && take(entry, fieldCount);
+
+    fields.clear();
+    for (auto i = 0U; valid && i < fieldCount; ++i) {
+      valid = takeField(entry, fields);
+    }
+    // the offsets of the following entries cannot be trusted either
+    if (!valid || !entry.empty()) {
+      break;
+    }
+    if (!all && (flags & FLAG_DELIVERED) != 0) {
+      continue;
+    }
+
+    const LogRecord record{
+      static_cast<Level::Value>(flags & LEVEL_MASK),
+      timestamp,
+      time,
+      context,
+      message,
+      {},
+      Fields(fields.data(), fields.size())};
+    m_appenderStore->forward(record, this);
+  }
+
+  clear();
+  m_replaying = false;
+}
+
+void FlightRecorder::dropOldest() {
+  EntrySize entrySize = 0;
+  read(0, &entrySize, sizeof(entrySize));
+  // a recovered file may be torn, head and size are not updated atomically
+  if (entrySize == 0 || entrySize > m_header->size) {
+    clear();
+    return;
+  }
+  m_header->head = (m_header->head + entrySize) % m_header->capacity;
+  m_header->size -= entrySize;
+}
+
+void FlightRecorder::write(
+  std::size_t& offset,
+  const void* data,
+  const std::size_t size) {
+  const auto capacity = m_header->capacity;
+  const auto start = (m_header->head + offset) % capacity;
+  const auto first = std::min(static_cast<std::size_t>(capacity - start), size);
+  const auto* const bytes = static_cast<const std::uint8_t*>(data);
+  std::memcpy(m_data + start, bytes, first);
+  std::memcpy(m_data, bytes + first, size - first);
+  offset += size;
+}
+
+void FlightRecorder::read(
+  const std::size_t offset,
+  void* data,
+  const std::size_t size) const {
+  const auto capacity = m_header->capacity;
+  const auto start = (m_header->head + offset) % capacity;
+  const auto first = std::min(static_cast<std::size_t>(capacity - start), size);
+  auto* const bytes = static_cast<std::uint8_t*>(data);
+  std::memcpy(bytes, m_data + start, first);
+  std::memcpy(bytes + first, m_data, size - first);
+}
+
+}  // namespace yal::appender
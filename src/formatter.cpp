@@ -0,0 +1,68 @@
+//
+// Copyright (c) 2022 Alexander Mohr
+// Licensed under the terms of the MIT License
+//
+
+#include <yal/Argument.hpp>
+#include <yal/Formatter.hpp>
+#include <array>
+#include <charconv>
+#include <cstdio>
+
+namespace yal {
+
+namespace {
+constexpr const auto NUMBER_BUFFER_SIZE = 32U;
+
+template<typename T>
+void writeNumber(std::string& out, T value) {
+  std::array<char, NUMBER_BUFFER_SIZE> buffer{};
+  const auto result = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+  out.append(buffer.data(), result.ptr);
+}
+}  // namespace
+
+void Formatter::writeInteger(std::string& out, const std::int64_t value) {
+  writeNumber(out, value);
+}
+
+void Formatter::writeUnsigned(std::string& out, const std::uint64_t value) {
+  writeNumber(out, value);
+}
+
+void Formatter::writeDouble(std::string& out, const double value) {
+  std::array<char, NUMBER_BUFFER_SIZE> buffer{};
+  const auto length = std::snprintf(buffer.data(), buffer.size(), "%g", value);
+  if (length > 0) {
+    out.append(buffer.data(), static_cast<std::size_t>(length));
+  }
+}
+
+void Argument::write(std::string& out) const {
+  switch (m_type) {
+    case Type::BOOL:
+      // matches std::ostream without std::boolalpha
+      out += m_value.b ? '1' : '0';
+      break;
+    case Type::CHAR:
+      out += m_value.c;
+      break;
+    case Type::INT:
+      Formatter::writeInteger(out, m_value.i);
+      break;
+    case Type::UINT:
+      Formatter::writeUnsigned(out, m_value.u);
+      break;
+    case Type::DOUBLE:
+      Formatter::writeDouble(out, m_value.d);
+      break;
+    case Type::STRING:
+      out.append(m_value.s.data, m_value.s.size);
+      break;
+    case Type::CUSTOM:
+      m_value.custom.write(out, m_value.custom.value);
+      break;
+  }
+}
+
+}  // namespace yal
@@ -0,0 +1,85 @@
+//
+// Copyright (c) 2022 Alexander Mohr
+// Licensed under the terms of the MIT License
+//
+
+#include <yal/Formatter.hpp>
+#include <yal/Metrics.hpp>
+
+namespace yal {
+
+void LoggerMetrics::reset() {
+  for (auto& counter : messages) {
+    counter.set(0);
+  }
+  for (auto& counter : captured) {
+    counter.set(0);
+  }
+  for (auto& counter : rejected) {
+    counter.set(0);
+  }
+  rateLimited.set(0);
+}
+
+void AppenderMetrics::recordLatency(
+  const unsigned long latencyUs,
+  const std::uint32_t messages) {
+  this->messages.add(messages);
+  calls.add();
+  maxLatencyUs.max(static_cast<std::uint32_t>(latencyUs));
+
+  auto bucket = 0U;
+  while (bucket + 1 < LATENCY_BUCKETS && latencyUs >= (1UL << bucket)) {
+    ++bucket;
+  }
+  this->latencyUs.at(bucket).add();
+}
+
+void AppenderMetrics::reset() {
+  messages.set(0);
+  calls.set(0);
+  bytes.set(0);
+  maxLatencyUs.set(0);
+  for (auto& counter : latencyUs) {
+    counter.set(0);
+  }
+}
+
+void Metrics::writeJson(std::string& out, const LoggerMetrics& metrics) {
+  writeArray(out, "messages", metrics.messages);
+  out += ',';
+  writeArray(out, "captured", metrics.captured);
+  out += ',';
+  writeArray(out, "rejected", metrics.rejected);
+  out += ",\"rateLimited\":";
+  Formatter::writeUnsigned(out, metrics.rateLimited.load());
+}
+
+void Metrics::writeJson(std::string& out, const AppenderMetrics& metrics) {
+  out += "\"appended\":";
+  Formatter::writeUnsigned(out, metrics.messages.load());
+  out += ",\"bytes\":";
+  Formatter::writeUnsigned(out, metrics.bytes.load());
+  out += ",\"calls\":";
+  Formatter::writeUnsigned(out, metrics.calls.load());
+  out += ",\"maxLatencyUs\":";
+  Formatter::writeUnsigned(out, metrics.maxLatencyUs.load());
+  out += ',';
+  writeArray(out, "latencyUs", metrics.latencyUs);
+}
+
+template<typename Counters>
+void Metrics::writeArray(std::string& out, const char* key, const Counters& counters) {
+  out += '"';
+  out += key;
+  out += "\":[";
+  for (auto i = 0U; i < counters.size(); ++i) {
+    if (i != 0) {
+      out += ',';
+    }
+    Formatter::writeUnsigned(out, counters[i].load());
+  }
+  out += ']';
+}
+
+}  // namespace yal
@@ -0,0 +1,167 @@
+//
+// Copyright (c) 2022 Alexander Mohr
+// Licensed under the terms of the MIT License
+//
+
+#include <yal/RateLimiter.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace yal {
+
+namespace {
+constexpr const std::uint32_t MILLI = 1000;
+constexpr const std::size_t SITES = YAL_RATE_LIMIT_SITES;
+static_assert(
+  YAL_RATE_LIMIT_CONTEXT_SIZE <= 255, "the context length is stored in a byte");
+
+// FNV-1a
+std::uint32_t hash(std::string_view text) {
+  auto value = std::uint32_t{2166136261U};
+  for (const auto character : text) {
+    value = (value ^ static_cast<std::uint8_t>(character)) * 16777619U;
+  }
+  return value;
+}
+
+// millis() wraps around, times are compared by their distance
+bool reached(const unsigned long now, const unsigned long time) {
+  return now - time < (~0UL >> 1U);
+}
+}  // namespace
+
+RateLimiter::Result RateLimiter::check(
+  const Format& format,
+  std::string_view context,
+  const Level& level,
+  const RateLimit& limit,
+  const unsigned long now) {
+  const LockGuard lock(m_mutex);
+  if (!m_sites) {
+    m_sites = std::make_unique<Site[]>(SITES);
+  }
+  const auto summariesDue = m_scheduled && reached(now, m_nextSummary);
+  const auto contextHash = hash(context);
+  auto* const entry = find(format.text, contextHash, level);
+  if (entry == nullptr) {
+    return {true, 0, summariesDue};
+  }
+
+  if (entry->key == nullptr) {
+    // first message of this call site
+    entry->key = format.text;
+    entry->contextHash = contextHash;
+    entry->contextLength =
+      static_cast<std::uint8_t>(std::min(context.size(), CONTEXT_SIZE));
+    std::memcpy(entry->context, context.data(), entry->contextLength);
+    entry->level = level.value();
+    entry->location = format.location;
+    entry->milliTokens = limit.burst * MILLI;
+    entry->lastRefill = now;
+    entry->duplicateWindow = limit.duplicateWindow;
+  } else {
+    if (limit.burst != 0) {
+      const auto elapsed = now - entry->lastRefill;
+      const auto refill = static_cast<std::uint64_t>(elapsed) * limit.perSecond;
+      entry->milliTokens = static_cast<std::uint32_t>(std::min<std::uint64_t>(
+        entry->milliTokens + refill, static_cast<std::uint64_t>(limit.burst) * MILLI));
+      entry->lastRefill = now;
+    }
+
+    entry->duplicateWindow = limit.duplicateWindow;
+    if (limit.duplicateWindow != 0 && now - entry->lastAllowed < limit.duplicateWindow)
+    {
+      ++entry->suppressed;
+      schedule(*entry);
+      return {false, entry->suppressed, summariesDue};
+    }
+  }
+
+  if (limit.burst != 0) {
+    if (entry->milliTokens < MILLI) {
+      ++entry->suppressed;
+      return {false, entry->suppressed, summariesDue};
+    }
+    entry->milliTokens -= MILLI;
+  }
+
+  entry->lastAllowed = now;
+  const auto suppressed = entry->suppressed;
+  entry->suppressed = 0;
+  return {true, suppressed, summariesDue};
+}
+
+void RateLimiter::takeSummaries(
+  std::vector<Summary>& out,
+  const unsigned long now,
+  const bool all) {
+  const LockGuard lock(m_mutex);
+  m_scheduled = false;
+  if (!m_sites) {
+    return;
+  }
+  for (auto i = std::size_t{0}; i < SITES; ++i) {
+    auto& entry = m_sites[i];
+    if (entry.suppressed == 0) {
+      continue;
+    }
+    if (all
+        || (entry.duplicateWindow != 0
+            && now - entry.lastAllowed >= entry.duplicateWindow))
+    {
+      out.push_back(
+        {std::string(entry.context, entry.contextLength),
+         entry.level,
+         entry.location,
+         entry.suppressed});
+      entry.suppressed = 0;
+    } else {
+      schedule(entry);
+    }
+  }
+}
+
+void RateLimiter::reset() {
+  const LockGuard lock(m_mutex);
+  // the table is kept, freeing it would fragment the heap
+  if (m_sites) {
+    std::fill_n(m_sites.get(), SITES, Site{});
+  }
+  m_scheduled = false;
+}
+
+void RateLimiter::schedule(const Site& site) {
+  if (site.duplicateWindow == 0) {
+    return;
+  }
+  const auto expiry = site.lastAllowed + site.duplicateWindow;
+  if (!m_scheduled || reached(m_nextSummary, expiry)) {
+    m_nextSummary = expiry;
+    m_scheduled = true;
+  }
+}
+
+RateLimiter::Site* RateLimiter::find(
+  const void* site,
+  const std::uint32_t contextHash,
+  const Level& level) {
+  const auto slot = reinterpret_cast<std::uintptr_t>(site) ^ contextHash
+                    ^ static_cast<std::uintptr_t>(level.value());
+
+  // linear probing, the table never shrinks so an empty slot ends the search
+  for (auto i = 0U; i < SITES; ++i) {
+    auto& entry = m_sites[(slot + i) % SITES];
+    if (entry.key == nullptr) {
+      return &entry;
+    }
+    if (entry.key == site && entry.level == level.value()
+        && entry.contextHash == contextHash)
+    {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace yal
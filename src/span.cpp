@@ -0,0 +1,239 @@
+//
+// Copyright (c) 2022 Alexander Mohr
+// Licensed under the terms of the MIT License
+//
+
+#include <yal/Encoder.hpp>
+#include <yal/Formatter.hpp>
+#include <yal/Span.hpp>
+#include <yal/yal.hpp>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#if !(HAVE_ARDUINO || YAL_ARDUINO_SUPPORT)
+#include <chrono>
+#endif
+
+namespace yal {
+
+namespace {
+using ShortLength = std::uint8_t;
+
+constexpr const std::size_t MAX_SHORT = std::numeric_limits<ShortLength>::max();
+constexpr const std::size_t SPAN_FIXED_SIZE =
+  sizeof(std::uint64_t) + sizeof(std::uint64_t) + sizeof(std::uint8_t)
+  + sizeof(ShortLength) + sizeof(ShortLength);
+constexpr const std::uint64_t NANOS_PER_MICRO = 1000;
+
+template<typename T>
+void append(std::string& out, const T& value) {
+  out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template<typename T>
+bool read(std::string_view& in, T& value) {
+  if (in.size() < sizeof(value)) {
+    return false;
+  }
+  std::memcpy(&value, in.data(), sizeof(value));
+  in.remove_prefix(sizeof(value));
+  return true;
+}
+
+bool readString(std::string_view& in, std::string_view& value) {
+  ShortLength length = 0;
+  if (!read(in, length) || in.size() < length) {
+    return false;
+  }
+  value = in.substr(0, length);
+  in.remove_prefix(length);
+  return true;
+}
+
+// ts and dur are in microseconds, written with nanosecond precision
+void writeMicros(std::string& out, const std::uint64_t nanos) {
+  constexpr const auto digits = 3;
+  Formatter::writeUnsigned(out, nanos / NANOS_PER_MICRO);
+  out += '.';
+  auto fraction = nanos % NANOS_PER_MICRO;
+  char text[digits];
+  for (auto i = digits - 1; i >= 0; --i) {
+    text[i] = static_cast<char>('0' + fraction % 10);
+    fraction /= 10;
+  }
+  out.append(text, digits);
+}
+}  // namespace
+
+struct Tracer::Buffer {
+  Mutex mutex;
+  std::uint32_t threadId = 0;
+  std::string data;
+};
+
+struct Tracer::Registry {
+  Mutex mutex;
+  // buffers outlive their threads until the spans are drained
+  std::vector<std::shared_ptr<Buffer>> buffers;
+  std::uint32_t nextThreadId = 1;
+};
+
+Tracer::Registry& Tracer::registry() {
+  static Registry registry;
+  return registry;
+}
+
+std::uint64_t Tracer::now() {
+#if !(HAVE_ARDUINO || YAL_ARDUINO_SUPPORT)
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+           std::chrono::steady_clock::now().time_since_epoch())
+    .count();
+#else
+  return static_cast<std::uint64_t>(micros()) * NANOS_PER_MICRO;
+#endif
+}
+
+std::uint8_t& Tracer::depth() {
+  static YAL_THREAD_LOCAL std::uint8_t depth = 0;
+  return depth;
+}
+
+Tracer::Buffer& Tracer::buffer() {
+  static YAL_THREAD_LOCAL std::shared_ptr<Buffer> buffer;
+  if (!buffer) {
+    buffer = std::make_shared<Buffer>();
+    buffer->data.reserve(YAL_TRACE_BUFFER_SIZE);
+
+    auto& registry = Tracer::registry();
+    const LockGuard lock(registry.mutex);
+    buffer->threadId = registry.nextThreadId++;
+    registry.buffers.push_back(buffer);
+  }
+  return *buffer;
+}
+
+void Tracer::record(
+  const std::uint64_t begin,
+  const std::uint64_t end,
+  const std::uint8_t depth,
+  std::string_view name,
+  std::string_view category) {
+  name = name.substr(0, MAX_SHORT);
+  category = category.substr(0, MAX_SHORT);
+
+  auto& buffer = Tracer::buffer();
+  const LockGuard lock(buffer.mutex);
+  if (buffer.data.size() + SPAN_FIXED_SIZE + name.size() + category.size()
+      > YAL_TRACE_BUFFER_SIZE)
+  {
+    s_dropped.add();
+    return;
+  }
+
+  append(buffer.data, begin);
+  append(buffer.data, static_cast<std::uint64_t>(end - begin));
+  append(buffer.data, depth);
+  append(buffer.data, static_cast<ShortLength>(name.size()));
+  buffer.data.append(name);
+  append(buffer.data, static_cast<ShortLength>(category.size()));
+  buffer.data.append(category);
+}
+
+void Tracer::drain(std::string& out) {
+  auto& registry = Tracer::registry();
+  const LockGuard lock(registry.mutex);
+  auto buffer = registry.buffers.begin();
+  while (buffer != registry.buffers.end()) {
+    // a buffer only referenced here belongs to a thread which has ended,
+    // checked before draining as a thread may record a span and exit in between
+    const auto ended = buffer->use_count() == 1;
+    {
+      const LockGuard bufferLock((*buffer)->mutex);
+      auto& data = (*buffer)->data;
+      if (!data.empty()) {
+        append(out, (*buffer)->threadId);
+        append(out, static_cast<std::uint32_t>(data.size()));
+        out.append(data);
+        data.clear();
+      }
+    }
+    buffer = ended ? registry.buffers.erase(buffer) : buffer + 1;
+  }
+}
+
+bool Tracer::writeChromeTrace(std::string& out, std::string_view trace) {
+  out += "{\"traceEvents\":[";
+  auto first = true;
+  auto complete = true;
+  while (!trace.empty() && complete) {
+    std::uint32_t threadId = 0;
+    std::uint32_t length = 0;
+    if (!read(trace, threadId) || !read(trace, length) || trace.size() < length) {
+      complete = false;
+      break;
+    }
+
+    auto spans = trace.substr(0, length);
+    trace.remove_prefix(length);
+    while (!spans.empty()) {
+      std::uint64_t begin = 0;
+      std::uint64_t duration = 0;
+      std::uint8_t depth = 0;
+      std::string_view name;
+      std::string_view category;
+      if (
+        !read(spans, begin) || !read(spans, duration) || !read(spans, depth)
+        || !readString(spans, name) || !readString(spans, category))
+      {
+        complete = false;
+        break;
+      }
+
+      if (!first) {
+        out += ',';
+      }
+      first = false;
+      out += "{\"name\":";
+      Encoder::writeJsonString(out, name);
+      out += ",\"cat\":";
+      Encoder::writeJsonString(out, category);
+      out += ",\"ph\":\"X\",\"ts\":";
+      writeMicros(out, begin);
+      out += ",\"dur\":";
+      writeMicros(out, duration);
+      out += ",\"pid\":1,\"tid\":";
+      Formatter::writeUnsigned(out, threadId);
+      out += ",\"args\":{\"depth\":";
+      Formatter::writeUnsigned(out, depth);
+      out += "}}";
+    }
+  }
+  out += "]}";
+  return complete;
+}
+
+void Tracer::writeChromeTrace(std::string& out) {
+  std::string trace;
+  drain(trace);
+  writeChromeTrace(out, trace);
+}
+
+Span::Span(const Logger& logger, const char* const name) :
+    m_logger(logger), m_name(name), m_active(Tracer::enabled()) {
+  if (m_active) {
+    ++Tracer::depth();
+    m_begin = Tracer::now();
+  }
+}
+
+Span::~Span() {
+  if (m_active) {
+    const auto end = Tracer::now();
+    const auto depth = --Tracer::depth();
+    Tracer::record(m_begin, end, depth, m_name, m_logger.context());
+  }
+}
+
+}  // namespace yal
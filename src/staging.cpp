@@ -0,0 +1,199 @@
+//
+// Copyright (c) 2022 Alexander Mohr
+// Licensed under the terms of the MIT License
+//
+
+#include <yal/LogBatch.hpp>
+#include <yal/yal.hpp>
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#if !(HAVE_ARDUINO || YAL_ARDUINO_SUPPORT)
+#include <atomic>
+#endif
+
+namespace yal {
+
+std::size_t LogBatch::writeHeader(
+  std::string& out,
+  const std::uint64_t sequence,
+  const Level& level) {
+  out.append(reinterpret_cast<const char*>(&sequence), sizeof(sequence));
+  out += static_cast<char>(static_cast<unsigned int>(level));
+  const auto sizeOffset = out.size();
+  out.append(sizeof(std::uint32_t), '\0');
+  return sizeOffset;
+}
+
+void LogBatch::commit(std::string& out, const std::size_t sizeOffset) {
+  const auto size =
+    static_cast<std::uint32_t>(out.size() - sizeOffset - sizeof(std::uint32_t));
+  std::memcpy(&out[sizeOffset], &size, sizeof(size));
+  out += '\0';
+}
+
+struct Logger::Stage {
+  struct Buffer {
+    Appender* appender;
+    std::string data;
+    std::size_t size;
+  };
+
+  Mutex mutex;
+  std::vector<Buffer> buffers;
+};
+
+struct Logger::StageRegistry {
+  Mutex mutex;
+  // stages outlive their threads until they are flushed
+  std::vector<std::shared_ptr<Stage>> stages;
+};
+
+Logger::StageRegistry& Logger::stageRegistry() {
+  static StageRegistry registry;
+  return registry;
+}
+
+Logger::Stage& Logger::stage() {
+  static YAL_THREAD_LOCAL std::shared_ptr<Stage> stage;
+  if (!stage) {
+    stage = std::make_shared<Stage>();
+    auto& registry = stageRegistry();
+    const LockGuard lock(registry.mutex);
+    registry.stages.push_back(stage);
+  }
+  return *stage;
+}
+
+bool& Logger::handingOff() {
+  static YAL_THREAD_LOCAL bool handingOff = false;
+  return handingOff;
+}
+
+std::uint64_t Logger::nextSequence() {
+#if !(HAVE_ARDUINO || YAL_ARDUINO_SUPPORT)
+  static std::atomic<std::uint64_t> sequence{0};
+  return sequence.fetch_add(1, std::memory_order_relaxed) + 1;
+#else
+  static std::uint64_t sequence = 0;
+  return ++sequence;
+#endif
+}
+
+void Logger::setStaging(const std::size_t batchSize, const Level& flushLevel) {
+  s_stagingSize.set(static_cast<std::uint32_t>(batchSize));
+  s_stagingFlushLevel = flushLevel;
+  if (batchSize == 0) {
+    flush();
+  }
+}
+
+void Logger::stage(
+  Appender& appender,
+  const LogRecord& record,
+  const std::size_t batchSize,
+  const bool handOffWhenFull) {
+  auto& stage = Logger::stage();
+  const LockGuard lock(stage.mutex);
+
+  auto buffer = std::find_if(
+    stage.buffers.begin(),
+    stage.buffers.end(),
+    [&appender](const auto& buffer) { return buffer.appender == &appender; });
+  if (buffer == stage.buffers.end()) {
+    stage.buffers.push_back({&appender, {}, 0});
+    buffer = stage.buffers.end() - 1;
+    buffer->data.reserve(batchSize + batchSize / 2);
+  }
+
+  auto& data = buffer->data;
+  const auto start = data.size();
+  const auto sizeOffset = LogBatch::writeHeader(data, record.sequence, record.level);
+  if (!Encoder::encode(appender.encoding(), data, appender.format(), record)) {
+    data.resize(start);
+    return;
+  }
+  if constexpr (METRICS_ENABLED) {
+    appender.metrics().bytes.add(
+      static_cast<std::uint32_t>(data.size() - sizeOffset - sizeof(std::uint32_t)));
+  }
+  LogBatch::commit(data, sizeOffset);
+  ++buffer->size;
+
+  // urgent messages are handed off right away, along with the messages before them
+  if (handOffWhenFull
+      && (data.size() >= batchSize || record.level >= s_stagingFlushLevel))
+  {
+    handOff(appender, data, buffer->size);
+  }
+}
+
+void Logger::handOff(Appender& appender, std::string& batch, std::size_t& size) {
+  if (size == 0) {
+    return;
+  }
+
+  {
+    const RecursiveLockGuard lock(appender.m_sinkMutex);
+    handingOff() = true;
+    if constexpr (METRICS_ENABLED) {
+      const auto start = micros();
+      appender.appendBatch(LogBatch(batch, size));
+      appender.metrics().recordLatency(
+        micros() - start, static_cast<std::uint32_t>(size));
+    } else {
+      appender.appendBatch(LogBatch(batch, size));
+    }
+    handingOff() = false;
+  }
+  batch.clear();
+  size = 0;
+}
+
+void Logger::appendDirect(Appender& appender, const LogRecord& record) {
+  if (s_stagingSize.load() == 0) {
+    appender.append(record);
+    return;
+  }
+  const RecursiveLockGuard lock(appender.m_sinkMutex);
+  appender.append(record);
+}
+
+void Logger::flush() {
+  // before locking the registry, dispatching may register the stage of this thread
+  dispatchSummaries(true);
+
+  auto& registry = stageRegistry();
+  const LockGuard lock(registry.mutex);
+  auto stage = registry.stages.begin();
+  while (stage != registry.stages.end()) {
+    // a stage only referenced here belongs to a thread which has ended,
+    // it cannot receive further messages and is empty once handed off.
+    // Checked before the hand off, a thread may log and exit in between.
+    const auto ended = stage->use_count() == 1;
+    {
+      const LockGuard stageLock((*stage)->mutex);
+      for (auto& buffer : (*stage)->buffers) {
+        handOff(*buffer.appender, buffer.data, buffer.size);
+      }
+    }
+    stage = ended ? registry.stages.erase(stage) : stage + 1;
+  }
+}
+
+void Logger::discardStaged(const Appender* appender) {
+  auto& registry = stageRegistry();
+  const LockGuard lock(registry.mutex);
+  for (const auto& stage : registry.stages) {
+    const LockGuard stageLock(stage->mutex);
+    stage->buffers.erase(
+      std::remove_if(
+        stage->buffers.begin(),
+        stage->buffers.end(),
+        [appender](const auto& buffer) { return buffer.appender == appender; }),
+      stage->buffers.end());
+  }
+}
+
+}  // namespace yal
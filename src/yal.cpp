@@ -4,10 +4,18 @@
 //
 
 #include <yal/yal.hpp>
+#include <algorithm>
 #include <iomanip>
+#include <vector>
 
 namespace yal {
 
+namespace {
+std::string repeated(const std::uint32_t suppressed) {
+  return "last message repeated " + std::to_string(suppressed) + " times";
+}
+}  // namespace
+
 Logger::Logger(std::string ctx) : m_context(std::move(ctx)) {
 }
 
@@ -21,7 +29,29 @@ std::size_t Logger::addAppender(Appender* appender) {
 void Logger::removeAppender(const AppenderId appenderId) {
   const auto element = s_appender.find(appenderId);
   if (element != s_appender.end()) {
+    discardStaged(element->second);
     s_appender.erase(element);
+    updateCaptureLevel();
+  }
+}
+
+void Logger::forward(const LogRecord& record, const Appender* source) {
+  // forwarded records are staged like new ones, so they follow the older staged
+  // messages of this thread and get a sequence number. They are not handed off
+  // right away, the source holds its sink lock while it forwards
+  const auto batchSize = handingOff() ? 0 : s_stagingSize.load();
+  auto staged = record;
+  staged.sequence = batchSize != 0 ? nextSequence() : 0;
+  for (const auto& appenderPair : s_appender) {
+    auto* const appender = appenderPair.second;
+    if (appender == source) {
+      continue;
+    }
+    if (batchSize != 0 && appender->supportsStaging()) {
+      stage(*appender, staged, batchSize, false);
+    } else {
+      appendDirect(*appender, record);
+    }
   }
 }
 
@@ -37,4 +67,190 @@ const Level& Logger::level() {
   return s_level;
 }
 
+void Logger::updateCaptureLevel() {
+  s_captureLevel = Level::OFF;
+  for (const auto& appenderPair : s_appender) {
+    s_captureLevel = std::min(s_captureLevel, appenderPair.second->captureLevel());
+  }
+}
+
+const Level& Logger::captureLevel() {
+  return s_captureLevel;
+}
+
+void Logger::reserve(const std::size_t size) {
+  ScratchBuffer<Logger>::reserve(size);
+  ScratchBuffer<Appender>::reserve(size);
+}
+
+const LoggerMetrics& Logger::metrics() {
+  return s_metrics;
+}
+
+void Logger::resetMetrics() {
+  s_metrics.reset();
+  for (const auto& appenderPair : s_appender) {
+    appenderPair.second->metrics().reset();
+  }
+}
+
+void Logger::setGlobalRateLimit(const RateLimit& limit) {
+  dispatchSummaries(true);
+  s_rateLimit = limit;
+  s_rateLimiter.reset();
+}
+
+void Logger::setRateLimit(const RateLimit& limit) {
+  m_rateLimit = limit;
+}
+
+void Logger::resetRateLimit() {
+  m_rateLimit.reset();
+}
+
+const RateLimit& Logger::rateLimit() const {
+  return m_rateLimit.has_value() ? *m_rateLimit : s_rateLimit;
+}
+
+void Logger::logArguments(
+  const Level& level,
+  const Fields& fields,
+  const Format& format,
+  const Arguments& arguments) const {
+  // messages only captured for a flight recorder are not rate limited
+  if (level >= s_level && !rateLimitAllows(level, format)) {
+    return;
+  }
+
+  ScratchBuffer<Logger> message;
+  buildMessage(message.str(), format.text, arguments);
+  dispatch(m_context, level, fields, format.location, message.str());
+}
+
+void Logger::buildMessage(
+  std::string& out,
+  const char* format,
+  const Arguments& arguments) {
+  if (format == nullptr) {
+    return;
+  }
+
+  // each % is replaced by the next argument, once all are used the rest is copied
+  auto argument = arguments.begin();
+  for (; *format != '\0' && argument != arguments.end(); ++format) {
+    if (*format == '%') {
+      argument->write(out);
+      ++argument;
+    } else {
+      out += *format;
+    }
+  }
+  out.append(format);
+}
+
+bool Logger::rateLimitAllows(const Level& level, const Format& format) const {
+  const auto& limit = rateLimit();
+  if (!limit.enabled()) {
+    return true;
+  }
+
+  const auto result = s_rateLimiter.check(format, m_context, level, limit, millis());
+  if (METRICS_ENABLED && !result.allowed) {
+    s_metrics.rateLimited.add();
+  }
+  // summaries of other call sites are older than this message
+  if (result.summariesDue) {
+    dispatchSummaries(false);
+  }
+  if (result.allowed && result.suppressed > 0) {
+    dispatch(
+      m_context,
+      level,
+      Fields(),
+      format.location,
+      repeated(result.suppressed));
+  }
+  return result.allowed;
+}
+
+void Logger::dispatchSummaries(const bool all) {
+  std::vector<RateLimiter::Summary> summaries;
+  s_rateLimiter.takeSummaries(summaries, millis(), all);
+  for (const auto& summary : summaries) {
+    dispatch(
+      summary.context,
+      summary.level,
+      Fields(),
+      summary.location,
+      repeated(summary.suppressed));
+  }
+}
+
+void Logger::dispatch(
+  const std::string& context,
+  const Level& level,
+  const Fields& fields,
+  const SourceLocation& location,
+  const std::string& message) {
+  const auto belowLevel = level < s_level;
+  if constexpr (METRICS_ENABLED) {
+    auto& counters = belowLevel ? s_metrics.captured : s_metrics.messages;
+    counters.at(static_cast<unsigned int>(level)).add();
+  }
+  if (s_appender.empty()) {
+    return;
+  }
+
+  const auto time = s_getTime();
+  // messages logged by an appender while it receives a batch are not staged again
+  const auto batchSize = handingOff() ? 0 : s_stagingSize.load();
+  LogRecord record{
+    level,
+    millis(),
+    time,
+    context,
+    message,
+    location,
+    fields,
+    batchSize != 0 ? nextSequence() : 0};
+  const auto deliver = [&](Appender& appender) {
+    if (belowLevel && level < appender.captureLevel()) {
+      return;
+    }
+    if (batchSize != 0 && appender.supportsStaging()) {
+      stage(appender, record, batchSize);
+      return;
+    }
+    if constexpr (METRICS_ENABLED) {
+      const auto start = micros();
+      appendDirect(appender, record);
+      appender.metrics().recordLatency(micros() - start);
+    } else {
+      appendDirect(appender, record);
+    }
+  };
+
+  // capturing appenders first, history they replay has to precede the record
+  const auto capturing = s_captureLevel < Level::OFF;
+  if (capturing) {
+    for (const auto& appenderPair : s_appender) {
+      if (appenderPair.second->captureLevel() < Level::OFF) {
+        deliver(*appenderPair.second);
+      }
+    }
+    // history forwarded by them is staged with newer sequence numbers
+    if (batchSize != 0) {
+      record.sequence = nextSequence();
+    }
+  }
+  if (belowLevel) {
+    return;
+  }
+  for (const auto& appenderPair : s_appender) {
+    if (!capturing || appenderPair.second->captureLevel() == Level::OFF) {
+      deliver(*appenderPair.second);
+    }
+  }
+}
+
 }  // namespace yal
@@ -0,0 +1,78 @@
+//
+// Copyright (c) 2022 Alexander Mohr
+// Licensed under the terms of the MIT License
+//
+
+#include <benchmark/benchmark.h>
+
+#include <yal/appender/ArduinoMQTT.hpp>
+#include <yal/appender/ArduinoSerial.hpp>
+#include <yal/yal.hpp>
+#include <string>
+
+namespace {
+
+class MQTT {
+ public:
+  void publish(const std::string& topic, const std::string& message) {
+    benchmark::DoNotOptimize(message.data());
+  }
+
+  void publish(const char* topic, const char* message, int length) {
+    benchmark::DoNotOptimize(message);
+  }
+
+  void subscribe(const std::string& topic) {
+  }
+};
+
+class HardwareSerial {
+ public:
+  void begin(unsigned long baud) {
+  }
+
+  void print(const char* const text) {
+    benchmark::DoNotOptimize(text);
+  }
+
+  void println(const char* const text) {
+    benchmark::DoNotOptimize(text);
+  }
+};
+
+void arduinoMQTT(benchmark::State& state) {
+  static constexpr const auto flushInterval = 64U;
+  MQTT mqtt;
+  yal::Logger logger("benchmark");
+  yal::appender::ArduinoMQTT<MQTT> appender(&logger, &mqtt, "/benchmark/log");
+  appender.setEncoding(static_cast<yal::Encoding>(state.range(0)));
+  yal::Logger::setLevel(yal::Level::TRACE);
+
+  auto count = 0U;
+  for (auto _ : state) {
+    logger.log(yal::Level::INFO, "message % %", 42, 3.15);
+    // keep the queue small, as a device would do in its loop
+    if (++count % flushInterval == 0) {
+      appender.flush();
+    }
+  }
+}
+BENCHMARK(arduinoMQTT)
+  ->Arg(static_cast<int>(yal::Encoding::TEXT))
+  ->Arg(static_cast<int>(yal::Encoding::JSON))
+  ->Arg(static_cast<int>(yal::Encoding::CBOR));
+
+void arduinoSerial(benchmark::State& state) {
+  HardwareSerial serial;
+  yal::Logger logger("benchmark");
+  const yal::appender::ArduinoSerial<HardwareSerial> appender(
+    &logger, &serial, state.range(0) != 0);
+  yal::Logger::setLevel(yal::Level::TRACE);
+
+  for (auto _ : state) {
+    logger.log(yal::Level::INFO, "message % %", 42, 3.15);
+  }
+}
+BENCHMARK(arduinoSerial)->Arg(0)->Arg(1);
+
+}  // namespace
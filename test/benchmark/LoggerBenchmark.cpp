@@ -0,0 +1,169 @@
+//
+// Copyright (c) 2022 Alexander Mohr
+// Licensed under the terms of the MIT License
+//
+
+#include <benchmark/benchmark.h>
+
+#include <NullAppender.hpp>
+#include <yal/yal.hpp>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+void disabledLevel(benchmark::State& state) {
+  yal::Logger logger("benchmark");
+  const auto appenders = createAppenders(logger, 1);
+  yal::Logger::setLevel(yal::Level::INFO);
+  for (auto _ : state) {
+    logger.log(yal::Level::DEBUG, "disabled % %", 42, 3.15);
+  }
+  yal::Logger::setLevel(yal::Level::TRACE);
+}
+BENCHMARK(disabledLevel);
+
+void plainText(benchmark::State& state) {
+  yal::Logger logger("benchmark");
+  const auto appenders = createAppenders(logger, 1);
+  yal::Logger::setLevel(yal::Level::TRACE);
+  for (auto _ : state) {
+    logger.log(yal::Level::INFO, "plain text message");
+  }
+}
+BENCHMARK(plainText);
+
+void multipleArguments(benchmark::State& state) {
+  yal::Logger logger("benchmark");
+  const auto appenders = createAppenders(logger, 1);
+  yal::Logger::setLevel(yal::Level::TRACE);
+  for (auto _ : state) {
+    logger.log(yal::Level::INFO, "int % double % string % char %", 42, 3.15, "str", 'c');
+  }
+}
+BENCHMARK(multipleArguments);
+
+void fields(benchmark::State& state) {
+  yal::Logger logger("benchmark");
+  const auto appenders = createAppenders(logger, 1, "%m %k");
+  yal::Logger::setLevel(yal::Level::TRACE);
+  for (auto _ : state) {
+    logger.log(yal::Level::INFO, {{"id", 42}, {"value", 3.15}}, "fields");
+  }
+}
+BENCHMARK(fields);
+
+// each format token on its own, the index selects the token
+void formatToken(benchmark::State& state) {
+  static constexpr std::array formats{"%t", "%m", "%c", "%l", "%k", "%s", "plain"};
+  const auto* const format = formats.at(static_cast<std::size_t>(state.range(0)));
+  state.SetLabel(format);
+
+  yal::Logger logger("benchmark");
+  const auto appenders = createAppenders(logger, 1, format);
+  yal::Logger::setLevel(yal::Level::TRACE);
+  for (auto _ : state) {
+    logger.log(yal::Level::INFO, {{"id", 42}}, "message %", 42);
+  }
+}
+BENCHMARK(formatToken)->DenseRange(0, 6);
+
+void encoding(benchmark::State& state) {
+  const auto encoding = static_cast<yal::Encoding>(state.range(0));
+  yal::Logger logger("benchmark");
+  const auto appenders = createAppenders(logger, 1);
+  appenders.front()->setEncoding(encoding);
+  yal::Logger::setLevel(yal::Level::TRACE);
+  for (auto _ : state) {
+    logger.log(yal::Level::INFO, {{"id", 42}, {"value", 3.15}}, "message %", 42);
+  }
+}
+BENCHMARK(encoding)
+  ->Arg(static_cast<int>(yal::Encoding::TEXT))
+  ->Arg(static_cast<int>(yal::Encoding::JSON))
+  ->Arg(static_cast<int>(yal::Encoding::CBOR));
+
+void appenderCount(benchmark::State& state) {
+  yal::Logger logger("benchmark");
+  const auto appenders =
+    createAppenders(logger, static_cast<std::size_t>(state.range(0)));
+  yal::Logger::setLevel(yal::Level::TRACE);
+  for (auto _ : state) {
+    logger.log(yal::Level::INFO, "message % %", 42, 3.15);
+  }
+}
+BENCHMARK(appenderCount)->Arg(1)->Arg(2)->Arg(8);
+
+void sampledOut(benchmark::State& state) {
+  yal::Logger logger("benchmark");
+  const auto appenders = createAppenders(logger, 1);
+  yal::Logger::setLevel(yal::Level::TRACE);
+  yal::EveryN sampler(std::numeric_limits<std::uint32_t>::max());
+  sampler.sample();
+  for (auto _ : state) {
+    logger.log(sampler, yal::Level::INFO, "message % %", 42, 3.15);
+  }
+}
+BENCHMARK(sampledOut);
+
+void multiThreaded(benchmark::State& state) {
+  static yal::Logger logger("benchmark");
+  static std::vector<std::unique_ptr<NullAppender>> appenders;
+  if (state.thread_index() == 0) {
+    appenders = createAppenders(logger, 1);
+    yal::Logger::setLevel(yal::Level::TRACE);
+  }
+
+  for (auto _ : state) {
+    logger.log(yal::Level::INFO, "message % %", 42, 3.15);
+  }
+  state.SetItemsProcessed(state.iterations());
+
+  if (state.thread_index() == 0) {
+    appenders.clear();
+  }
+}
+BENCHMARK(multiThreaded)->ThreadRange(1, 8)->UseRealTime();
+
+// sink which serializes writes, as a serial port or file would
+class LockedAppender : public NullAppender {
+ public:
+  using NullAppender::NullAppender;
+
+ protected:
+  void append(const yal::Level& level, const char* text) override {
+    const std::lock_guard<std::mutex> lock(m_mutex);
+    NullAppender::append(level, text);
+  }
+
+ private:
+  std::mutex m_mutex;
+};
+
+// the argument is the staging batch size, 0 calls the sink for every message
+void staging(benchmark::State& state) {
+  static yal::Logger logger("benchmark");
+  static std::unique_ptr<LockedAppender> appender;
+  if (state.thread_index() == 0) {
+    appender = std::make_unique<LockedAppender>(&logger);
+    yal::Logger::setLevel(yal::Level::TRACE);
+    yal::Logger::setStaging(static_cast<std::size_t>(state.range(0)));
+  }
+
+  for (auto _ : state) {
+    logger.log(yal::Level::INFO, "message % %", 42, 3.15);
+  }
+  state.SetItemsProcessed(state.iterations());
+
+  if (state.thread_index() == 0) {
+    yal::Logger::setStaging(0);
+    appender.reset();
+  }
+}
+BENCHMARK(staging)->Arg(0)->Arg(4096)->ThreadRange(1, 8)->UseRealTime();
+
+}  // namespace
@@ -0,0 +1,45 @@
+//
+// Copyright (c) 2022 Alexander Mohr
+// Licensed under the terms of the MIT License
+//
+
+#ifndef YAL_BENCHMARK_NULLAPPENDER_HPP
+#define YAL_BENCHMARK_NULLAPPENDER_HPP
+
+#include <benchmark/benchmark.h>
+
+#include <yal/yal.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Appender which only keeps the compiler from optimizing the message away,
+ * so the benchmarks measure the cost of the logger itself
+ */
+class NullAppender : public yal::Appender {
+ public:
+  explicit NullAppender(
+    yal::AppenderStorage* storage,
+    const std::string& format = yal::Logger::DEFAULT_FORMAT) :
+      yal::Appender(storage, format) {
+  }
+
+ protected:
+  void append(const yal::Level& level, const char* text) override {
+    benchmark::DoNotOptimize(text);
+  }
+};
+
+inline std::vector<std::unique_ptr<NullAppender>> createAppenders(
+  yal::Logger& logger,
+  const std::size_t count,
+  const std::string& format = yal::Logger::DEFAULT_FORMAT) {
+  std::vector<std::unique_ptr<NullAppender>> appenders;
+  for (auto i = 0U; i < count; ++i) {
+    appenders.push_back(std::make_unique<NullAppender>(&logger, format));
+  }
+  return appenders;
+}
+
+#endif  // YAL_BENCHMARK_NULLAPPENDER_HPP
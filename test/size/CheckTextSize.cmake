@@ -0,0 +1,23 @@
+# Fails if the .text section of REFERENCE grew by more than
+# MAX_CALL_SITE_SIZE bytes per call site compared to BASE
+function(text_size FILE RESULT)
+    execute_process(
+            COMMAND ${SIZE_TOOL} -A ${FILE}
+            OUTPUT_VARIABLE OUTPUT
+            RESULT_VARIABLE ERROR)
+    if (ERROR)
+        message(FATAL_ERROR "${SIZE_TOOL} failed for ${FILE}")
+    endif()
+    string(REGEX MATCH "\n\\.text +([0-9]+)" MATCH "${OUTPUT}")
+    set(${RESULT} ${CMAKE_MATCH_1} PARENT_SCOPE)
+endfunction()
+
+text_size(${BASE} BASE_SIZE)
+text_size(${REFERENCE} REFERENCE_SIZE)
+math(EXPR PER_CALL_SITE "(${REFERENCE_SIZE} - ${BASE_SIZE}) / ${CALL_SITES}")
+message(
+        "text: ${BASE_SIZE} bytes without, ${REFERENCE_SIZE} bytes with ${CALL_SITES} call sites, "
+        "${PER_CALL_SITE} bytes per call site (budget ${MAX_CALL_SITE_SIZE})")
+if (PER_CALL_SITE GREATER MAX_CALL_SITE_SIZE)
+    message(FATAL_ERROR "log call sites exceed the size budget")
+endif()
@@ -0,0 +1,55 @@
+//
+// Copyright (c) 2022 Alexander Mohr
+// Licensed under the terms of the MIT License
+//
+
+// Host side stand in for platformio/src/main.cpp.
+// Built twice, with and without YAL_SIZE_CALL_SITES, to measure the code
+// each additional call site adds to the binary.
+
+#include <yal/yal.hpp>
+#include <cstdint>
+#include <string>
+
+class SizeAppender : public yal::Appender {
+ public:
+  explicit SizeAppender(yal::AppenderStorage* storage) : Appender(storage, "%m") {
+  }
+
+  void append(const yal::Level& level, const char* text) override {
+    m_length += std::char_traits<char>::length(text);
+  }
+
+  std::size_t m_length = 0;
+};
+
+int main(int argc, char** argv) {
+  yal::Logger logger;
+  SizeAppender appender(&logger);
+  const auto value = argc;
+  const std::string text = argv[0];
+
+  // links the formatting core into both binaries
+  logger.log(yal::Level::INFO, "baseline % %", value, text);
+
+#if defined(YAL_SIZE_CALL_SITES)
+  logger.log(yal::Level::DEBUG, "int %", value);
+  logger.log(yal::Level::DEBUG, "unsigned %", static_cast<unsigned>(value));
+  logger.log(yal::Level::DEBUG, "int64 %", static_cast<std::int64_t>(value));
+  logger.log(yal::Level::DEBUG, "uint8 %", static_cast<std::uint8_t>(value));
+  logger.log(yal::Level::DEBUG, "double %", value * 1.5);
+  logger.log(yal::Level::DEBUG, "float %", value * 1.5F);
+  logger.log(yal::Level::DEBUG, "bool %", value > 1);
+  logger.log(yal::Level::DEBUG, "char %", static_cast<char>('a' + value));
+  logger.log(yal::Level::DEBUG, "string %", text);
+  logger.log(yal::Level::DEBUG, "literal %", "literal");
+  logger.log(yal::Level::DEBUG, "int double % %", value, value * 0.5);
+  logger.log(yal::Level::DEBUG, "string int % %", text, value);
+  logger.log(yal::Level::DEBUG, "three % % %", value, text, value > 2);
+  logger.log(yal::Level::DEBUG, "four % % % %", value, 1.5, 'c', text);
+  logger.log(yal::Level::DEBUG, "five % % % % %", value, 1U, 2L, 3.0F, "x");
+  logger.log(yal::Level::DEBUG, "six % % % % % %", 1, 2, 3, 4, 5, text);
+#endif
+
+  return appender.m_length == 0 ? 1 : 0;
+}
@@ -0,0 +1,232 @@
+//
+// Copyright (c) 2022 Alexander Mohr
+// Licensed under the terms of the MIT License
+//
+
+#include <gtest/gtest.h>
+
+#include <yal/appender/ArduinoMQTT.hpp>
+#include <yal/appender/ArduinoSerial.hpp>
+#include <yal/yal.hpp>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <ostream>
+#include <string>
+
+// global allocation hooks for the whole test binary,
+// allocations are only counted while a counter is active
+namespace {
+std::atomic<bool> s_counting{false};
+std::atomic<std::size_t> s_allocations{0};
+
+void* allocate(std::size_t size) {
+  if (s_counting) {
+    ++s_allocations;
+  }
+  if (auto* const memory = std::malloc(size == 0 ? 1 : size)) {
+    return memory;
+  }
+  throw std::bad_alloc();
+}
+}  // namespace
+
+void* operator new(std::size_t size) {
+  return allocate(size);
+}
+
+void* operator new[](std::size_t size) {
+  return allocate(size);
+}
+
+void operator delete(void* memory) noexcept {
+  std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+  std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+  std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+  std::free(memory);
+}
+
+class AllocationCounter {
+ public:
+  AllocationCounter() {
+    s_allocations = 0;
+    s_counting = true;
+  }
+
+  AllocationCounter(const AllocationCounter&) = delete;
+  AllocationCounter& operator=(const AllocationCounter&) = delete;
+
+  ~AllocationCounter() {
+    s_counting = false;
+  }
+
+  [[nodiscard]] std::size_t count() const {
+    return s_allocations;
+  }
+};
+
+class SilentAppender : public yal::Appender {
+ public:
+  explicit SilentAppender(
+    yal::AppenderStorage* storage,
+    const std::string& format = yal::Logger::DEFAULT_FORMAT) :
+      yal::Appender(storage, format) {
+  }
+
+  std::size_t m_size = 0;
+
+ protected:
+  void appendEncoded(const yal::Level& level, const char* data, std::size_t size)
+    override {
+    m_size = size;
+  }
+};
+
+class FakeSerial {
+ public:
+  void begin(unsigned long baud) {
+  }
+
+  void print(const char* const text) {
+  }
+
+  void println(const char* const text) {
+    ++m_lines;
+  }
+
+  std::size_t m_lines = 0;
+};
+
+class FakeMQTT {
+ public:
+  void publish(const std::string& topic, const std::string& message) {
+  }
+
+  void publish(const char* topic, const char* message, int length) {
+  }
+
+  void subscribe(const std::string& topic) {
+  }
+};
+
+class AllocationTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    yal::Logger::setTimeFunc([]() { return "123456789"; });
+    yal::Logger::setLevel(yal::Level::DEBUG);
+    yal::Logger::reserve(m_reserve);
+  }
+
+  template<typename Log>
+  static std::size_t steadyStateAllocations(Log&& log) {
+    // the first message may grow the buffers
+    log();
+    const AllocationCounter counter;
+    for (auto i = 0; i < m_iterations; ++i) {
+      log();
+    }
+    return counter.count();
+  }
+
+  static constexpr const auto m_iterations = 100;
+  static constexpr const auto m_reserve = 256U;
+  yal::Logger m_logger = yal::Logger("allocation");
+};
+
+TEST_F(AllocationTest, disabledLevel) {
+  const SilentAppender appender(&m_logger);
+  const std::string longArgument(100, 'x');
+  const AllocationCounter counter;
+  m_logger.log(yal::Level::TRACE, "disabled % %", 42, longArgument);
+  EXPECT_EQ(counter.count(), 0);
+}
+
+TEST_F(AllocationTest, reservedBuffersDoNotAllocate) {
+  const SilentAppender appender(&m_logger);
+  const AllocationCounter counter;
+  m_logger.log(yal::Level::INFO, "first message after reserve is % long", "quite");
+  EXPECT_EQ(counter.count(), 0);
+}
+
+TEST_F(AllocationTest, text) {
+  const SilentAppender appender(&m_logger);
+  const std::string longArgument(100, 'x');
+  EXPECT_EQ(
+    steadyStateAllocations([&]() {
+      m_logger.log(
+        yal::Level::INFO, "% % % % %", 42, -1L, 3.15, true, longArgument);
+    }),
+    0);
+}
+
+TEST_F(AllocationTest, encodings) {
+  SilentAppender text(&m_logger, "%t %l %c %m %k %s");
+  SilentAppender json(&m_logger);
+  SilentAppender cbor(&m_logger);
+  json.setEncoding(yal::Encoding::JSON);
+  cbor.setEncoding(yal::Encoding::CBOR);
+  EXPECT_EQ(
+    steadyStateAllocations([&]() {
+      m_logger.log(
+        yal::Level::INFO, {{"id", 42}, {"name", "sensor"}, {"value", 1.5}}, "fields");
+    }),
+    0);
+}
+
+TEST_F(AllocationTest, sampledOut) {
+  const SilentAppender appender(&m_logger);
+  yal::EveryN sampler(m_iterations * 2);
+  EXPECT_EQ(
+    steadyStateAllocations([&]() { m_logger.log(sampler, yal::Level::INFO, "%", 1); }),
+    0);
+}
+
+TEST_F(AllocationTest, arduinoSerial) {
+  FakeSerial serial;
+  const yal::appender::ArduinoSerial<FakeSerial> appender(&m_logger, &serial, true);
+  EXPECT_EQ(
+    steadyStateAllocations([&]() { m_logger.log(yal::Level::INFO, "value %", 42); }),
+    0);
+  EXPECT_EQ(serial.m_lines, m_iterations + 1);
+}
+
+TEST_F(AllocationTest, arduinoMQTTAllocatesPayload) {
+  FakeMQTT mqtt;
+  // the topic fits into the small string buffer and is not allocated
+  yal::appender::ArduinoMQTT<FakeMQTT> appender(&m_logger, &mqtt, "/log");
+  m_logger.log(yal::Level::INFO, "value %", 42);
+  appender.flush();
+
+  // the queue owns the payload, so each message allocates it once.
+  // The storage of the queue itself is allocated in blocks of several messages,
+  // the second message always fits into the first block.
+  const AllocationCounter counter;
+  m_logger.log(yal::Level::INFO, "value %", 42);
+  EXPECT_EQ(counter.count(), 1);
+  appender.flush();
+}
+
+struct Streamable {
+  std::string m_text = std::string(100, 'x');
+};
+
+std::ostream& operator<<(std::ostream& stream, const Streamable& streamable) {
+  return stream << streamable.m_text;
+}
+
+TEST_F(AllocationTest, streamedTypesAllocate) {
+  const SilentAppender appender(&m_logger);
+  const Streamable streamable;
+  const AllocationCounter counter;
+  m_logger.log(yal::Level::INFO, "%", streamable);
+  EXPECT_GT(counter.count(), 0);
+}
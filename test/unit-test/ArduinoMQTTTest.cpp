@@ -22,6 +22,7 @@ class MQTT {
   MQTT() = default;
   MQTT(MQTT&) = delete;
   MOCK_METHOD2(publish, void(std::string, std::string));
+  MOCK_METHOD3(publish, void(const char*, const char*, int));
   MOCK_METHOD1(subscribe, void(const std::string&));
 };
 
@@ -80,3 +81,109 @@ TEST_F(ArduinoMQTTTest, setTopic) {
   appender.setTopic(newTopic);
   EXPECT_STREQ(newTopic.c_str(), appender.topic());
 }
+
+TEST_F(ArduinoMQTTTest, cborPublishedWithLength) {
+  MQTT mqtt;
+  yal::Logger logger;
+  yal::Logger::setLevel(yal::Level::DEBUG);
+  yal::appender::ArduinoMQTT<MQTT> appender(&logger, &mqtt, "/log");
+  appender.setEncoding(yal::Encoding::CBOR);
+  logger.log(yal::Level::DEBUG, {{"zero", 0}}, "bar");
+
+  ASSERT_EQ(appender.queue().size(), 1);
+  const auto payload = appender.queue().front().message;
+  // 0 encodes as a null byte, so the payload must not be truncated
+  EXPECT_EQ(payload.back(), '\0');
+  EXPECT_CALL(mqtt, publish(testing::StrEq("/log"), testing::_, payload.size()));
+  appender.flush();
+}
+
+TEST_F(ArduinoMQTTTest, dropWhenQueueFull) {
+  MQTT mqtt;
+  yal::Logger logger;
+  yal::Logger::setLevel(yal::Level::DEBUG);
+  yal::appender::ArduinoMQTT<MQTT> appender(&logger, &mqtt, "/log", "%m");
+  appender.setMaxQueueSize(2);
+  for (auto i = 0; i < 5; ++i) {
+    logger.log(yal::Level::INFO, "msg");
+  }
+
+  EXPECT_EQ(appender.queue().size(), 2);
+  EXPECT_EQ(appender.dropped(), 3);
+  EXPECT_EQ(appender.maxQueueDepth(), 2);
+
+  EXPECT_CALL(mqtt, publish(std::string("/log"), std::string("msg"))).Times(2);
+  appender.flush();
+}
+
+TEST_F(ArduinoMQTTTest, publishStats) {
+  MQTT mqtt;
+  yal::Logger logger;
+  yal::Logger::setLevel(yal::Level::DEBUG);
+  yal::Logger::resetMetrics();
+  yal::appender::ArduinoMQTT<MQTT> appender(&logger, &mqtt, "/log", "%m");
+  appender.setStatsTopic("/stats", 0);
+  logger.log(yal::Level::INFO, "msg");
+
+  // stats are queued behind the pending messages
+  testing::InSequence seq;
+  EXPECT_CALL(mqtt, publish(std::string("/log"), std::string("msg")));
+  EXPECT_CALL(
+    mqtt,
+    publish(
+      std::string("/stats"),
+      testing::AllOf(
+        testing::StartsWith(R"({"queue":1,"maxQueue":1,"dropped":0,"messages":[0,0,1,)"),
+        testing::HasSubstr(R"("appended":1,"bytes":3,)"),
+        testing::EndsWith("]}"))));
+  appender.flush();
+  appender.setStatsTopic("", 0);
+}
+
+TEST_F(ArduinoMQTTTest, batching) {
+  MQTT mqtt;
+  yal::Logger logger;
+  yal::Logger::setLevel(yal::Level::DEBUG);
+  yal::appender::ArduinoMQTT<MQTT> appender(&logger, &mqtt, "/log", "%m");
+  appender.setBatching(10);
+  logger.log(yal::Level::INFO, "first");
+  logger.log(yal::Level::INFO, "second");
+  logger.log(yal::Level::INFO, "third");
+
+  // the first payload is full, the second is queued by flush
+  EXPECT_EQ(appender.queue().size(), 1);
+  testing::InSequence seq;
+  EXPECT_CALL(mqtt, publish(std::string("/log"), std::string("first\nsecond")));
+  EXPECT_CALL(mqtt, publish(std::string("/log"), std::string("third")));
+  appender.flush();
+}
+
+TEST_F(ArduinoMQTTTest, compressedBatch) {
+  MQTT mqtt;
+  yal::Logger logger("sensor");
+  yal::Logger::setLevel(yal::Level::DEBUG);
+  yal::appender::ArduinoMQTT<MQTT> appender(&logger, &mqtt, "/log");
+  const auto dictionary = yal::Compressor::dictionary(appender.format(), {"sensor"});
+  appender.setBatching(512);
+  appender.enableCompression(dictionary);
+
+  std::string expected;
+  for (auto i = 0; i < 20; ++i) {
+    logger.log(yal::Level::INFO, "temperature % C", 20 + i % 3);
+    expected += (i == 0 ? "" : "\n")
+                + "[00000000000123456789][INFO ][sensor] temperature "s
+                + std::to_string(20 + i % 3) + " C";
+  }
+
+  std::string payload;
+  EXPECT_CALL(mqtt, publish(testing::StrEq("/log"), testing::_, testing::_))
+    .WillOnce([&payload](const char* topic, const char* data, int size) {
+      payload.assign(data, static_cast<std::size_t>(size));
+    });
+  appender.flush();
+
+  std::string result;
+  EXPECT_TRUE(yal::Compressor::decompress(payload, dictionary, result));
+  EXPECT_EQ(result, expected);
+  EXPECT_LT(payload.size(), expected.size() / 4);
+}
@@ -0,0 +1,32 @@
+//
+// Copyright (c) 2022 Alexander Mohr
+// Licensed under the terms of the MIT License
+//
+
+#ifndef YAL_UNITTEST_COLLECTINGAPPENDER_HPP
+#define YAL_UNITTEST_COLLECTINGAPPENDER_HPP
+
+#include <yal/yal.hpp>
+#include <string>
+#include <vector>
+
+/**
+ * Appender which keeps every formatted message, in the order received
+ */
+class CollectingAppender : public yal::Appender {
+ public:
+  explicit CollectingAppender(
+    yal::AppenderStorage* storage,
+    const std::string& format = "%m") :
+      yal::Appender(storage, format) {
+  }
+
+  std::vector<std::string> m_messages;
+
+ protected:
+  void append(const yal::Level& level, const char* text) override {
+    m_messages.emplace_back(text);
+  }
+};
+
+#endif  // YAL_UNITTEST_COLLECTINGAPPENDER_HPP
@@ -0,0 +1,111 @@
+//
+// Copyright (c) 2022 Alexander Mohr
+// Licensed under the terms of the MIT License
+//
+
+#include <gtest/gtest.h>
+
+#include <yal/Compressor.hpp>
+#include <yal/yal.hpp>
+#include <random>
+#include <string>
+
+class CompressorTest : public testing::Test {
+ protected:
+  static std::string compress(
+    const std::string& text,
+    const std::string& dictionary = "") {
+    yal::Compressor compressor(dictionary);
+    std::string payload;
+    compressor.begin(payload);
+    compressor.write(payload, text.data(), text.size());
+    return payload;
+  }
+
+  static std::string roundTrip(
+    const std::string& text,
+    const std::string& dictionary = "") {
+    std::string result;
+    const auto payload = compress(text, dictionary);
+    EXPECT_TRUE(yal::Compressor::decompress(payload, dictionary, result));
+    return result;
+  }
+
+  static std::string logLines(std::size_t count) {
+    std::string text;
+    for (auto i = 0U; i < count; ++i) {
+      text += "[0000000000000012" + std::to_string(3456 + i * 17)
+              + "][INFO ][sensor] temperature " + std::to_string(20 + i % 5) + " C\n";
+    }
+    return text;
+  }
+};
+
+TEST_F(CompressorTest, roundTrip) {
+  EXPECT_EQ(roundTrip(""), "");
+  EXPECT_EQ(roundTrip("a"), "a");
+  EXPECT_EQ(roundTrip("abcabcabcabc"), "abcabcabcabc");
+  // the match overlaps the bytes it produces
+  EXPECT_EQ(roundTrip(std::string(1000, 'x')), std::string(1000, 'x'));
+  EXPECT_EQ(roundTrip(logLines(50)), logLines(50));
+}
+
+TEST_F(CompressorTest, longStreamRoundTrip) {
+  // the index truncates positions to 16 bits
+  const auto text = logLines(1500);
+  ASSERT_GT(text.size(), 65536);
+  EXPECT_EQ(roundTrip(text), text);
+  EXPECT_LT(compress(text).size(), text.size() / 3);
+}
+
+TEST_F(CompressorTest, binaryRoundTrip) {
+  std::mt19937 generator(42);
+  std::string data;
+  for (auto i = 0; i < 3000; ++i) {
+    data += static_cast<char>(generator() % 4 == 0 ? 0 : generator());
+  }
+  EXPECT_EQ(roundTrip(data), data);
+}
+
+TEST_F(CompressorTest, compressesLogText) {
+  const auto text = logLines(50);
+  EXPECT_LT(compress(text).size(), text.size() / 3);
+}
+
+TEST_F(CompressorTest, dictionaryPrimesShortPayloads) {
+  const auto dictionary =
+    yal::Compressor::dictionary(yal::Logger::DEFAULT_FORMAT, {"sensor"});
+  EXPECT_NE(
+    dictionary.find("[00000000000000000000][INFO ][sensor] \n"), std::string::npos);
+
+  const std::string line = "[00000000000000123456][INFO ][sensor] temperature 21 C";
+  EXPECT_LT(compress(line, dictionary).size(), compress(line).size() * 2 / 3);
+  EXPECT_EQ(roundTrip(line, dictionary), line);
+}
+
+TEST_F(CompressorTest, writesAreOneStream) {
+  const auto text = logLines(20);
+  yal::Compressor compressor;
+  std::string payload;
+  compressor.begin(payload);
+  for (auto i = std::size_t{0}; i < text.size(); i += 7) {
+    compressor.write(payload, text.data() + i, std::min<std::size_t>(7, text.size() - i));
+  }
+
+  std::string result;
+  EXPECT_TRUE(yal::Compressor::decompress(payload, "", result));
+  EXPECT_EQ(result, text);
+
+  // the compressor restarts from the dictionary for the next payload
+  EXPECT_EQ(roundTrip("next"), "next");
+}
+
+TEST_F(CompressorTest, corruptPayload) {
+  std::string result;
+  EXPECT_FALSE(yal::Compressor::decompress("", "", result));
+  EXPECT_FALSE(yal::Compressor::decompress(std::string(1, '\x20'), "", result));
+
+  auto payload = compress(std::string(100, 'x'));
+  payload.pop_back();
+  EXPECT_FALSE(yal::Compressor::decompress(payload, "", result));
+}
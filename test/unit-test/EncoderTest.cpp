@@ -0,0 +1,79 @@
+//
+// Copyright (c) 2022 Alexander Mohr
+// Licensed under the terms of the MIT License
+//
+
+#include <gtest/gtest.h>
+
+#include <yal/Encoder.hpp>
+#include <cmath>
+#include <string>
+
+using std::string_literals::operator""s;
+
+class EncoderTest : public testing::Test {
+ protected:
+  static yal::LogRecord record(
+    const yal::Level& level,
+    std::string_view message,
+    const yal::Fields& fields) {
+    return {level, 1, "1", "ctx", message, {"file.cpp", 42}, fields};
+  }
+
+  static std::string encode(yal::Encoding encoding, const yal::Fields& fields) {
+    std::string out;
+    yal::Encoder::encode(
+      encoding, out, "%l %m %k", record(yal::Level::WARNING, "msg", fields));
+    return out;
+  }
+};
+
+TEST_F(EncoderTest, textWithoutFormat) {
+  std::string out;
+  EXPECT_FALSE(
+    yal::Encoder::encodeText(out, "", record(yal::Level::INFO, "msg", yal::Fields())));
+  EXPECT_TRUE(out.empty());
+}
+
+TEST_F(EncoderTest, textSource) {
+  std::string out;
+  yal::Encoder::encodeText(out, "%s", record(yal::Level::INFO, "msg", yal::Fields()));
+  EXPECT_EQ(out, "file.cpp:42");
+}
+
+TEST_F(EncoderTest, text) {
+  EXPECT_EQ(encode(yal::Encoding::TEXT, {{"a", 1}, {"b", "x"}}), "WARN msg a=1 b=x");
+}
+
+TEST_F(EncoderTest, jsonEscaping) {
+  std::string out;
+  yal::Encoder::encodeJson(
+    out, record(yal::Level::INFO, "a\nb\x01\\", {{"nan", std::nan("")}}));
+  EXPECT_EQ(
+    out,
+    R"({"time":"1","level":"INFO","context":"ctx","message":"a\nb\u0001\\","nan":null})");
+}
+
+TEST_F(EncoderTest, cbor) {
+  const auto out = encode(
+    yal::Encoding::CBOR, {{"n", -500}, {"u", 24U}, {"b", false}, {"d", 1.0}});
+  const auto expected =
+    // map with 8 entries
+    "\xa8"
+    "\x64time\x61"
+    "1"
+    "\x65level\x64WARN"
+    "\x67"
+    "context\x63"
+    "ctx"
+    "\x67message\x63msg"
+    // -500 => major type 1, 499 as uint16
+    "\x61n\x39\x01\xf3"
+    // 24 does not fit the initial byte
+    "\x61u\x18\x18"
+    "\x61"
+    "b\xf4"
+    "\x61"
+    "d\xfb\x3f\xf0\x00\x00\x00\x00\x00\x00"s;
+  EXPECT_EQ(out, expected);
+}
@@ -0,0 +1,167 @@
+//
+// Copyright (c) 2022 Alexander Mohr
+// Licensed under the terms of the MIT License
+//
+
+#include <gtest/gtest.h>
+
+#include <CollectingAppender.hpp>
+#include <yal/appender/FlightRecorder.hpp>
+#include <yal/yal.hpp>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+class FlightRecorderTest : public testing::Test {
+ protected:
+  static constexpr const char* FORMAT = "%l %m %k";
+
+  void SetUp() override {
+    yal::Logger::setTimeFunc([]() { return "1"; });
+    yal::Logger::setLevel(yal::Level::INFO);
+  }
+
+  void TearDown() override {
+    yal::Logger::setLevel(yal::Level::TRACE);
+  }
+
+  yal::Logger m_logger = yal::Logger("recorder");
+};
+
+TEST_F(FlightRecorderTest, dumpOnError) {
+  yal::appender::FlightRecorder recorder(&m_logger, 1024);
+  CollectingAppender appender(&m_logger, FORMAT);
+
+  m_logger.log(yal::Level::TRACE, "trace %", 1);
+  m_logger.log(yal::Level::DEBUG, {{"id", 7}, {"name", "x"}}, "debug");
+  m_logger.log(yal::Level::INFO, "info");
+  EXPECT_EQ(appender.m_messages, std::vector<std::string>{"INFO  info "});
+
+  m_logger.log(yal::Level::ERROR, "error");
+  const std::vector<std::string> expected{
+    "INFO  info ", "TRACE trace 1 ", "DEBUG debug id=7 name=x", "ERROR error "};
+  EXPECT_EQ(appender.m_messages, expected);
+  EXPECT_EQ(recorder.size(), 0);
+}
+
+TEST_F(FlightRecorderTest, overwriteOldest) {
+  yal::appender::FlightRecorder recorder(
+    &m_logger, 64, yal::Level::TRACE, yal::Level::OFF);
+  CollectingAppender appender(&m_logger, FORMAT);
+
+  for (auto i = 0; i < 10; ++i) {
+    m_logger.log(yal::Level::DEBUG, "message %", i);
+  }
+  EXPECT_LE(recorder.size(), recorder.capacity());
+
+  recorder.dump();
+  ASSERT_FALSE(appender.m_messages.empty());
+  EXPECT_LT(appender.m_messages.size(), 10);
+  EXPECT_EQ(appender.m_messages.back(), "DEBUG message 9 ");
+}
+
+TEST_F(FlightRecorderTest, historyPrecedesErrorRegardlessOfRegistration) {
+  CollectingAppender appender(&m_logger, FORMAT);
+  yal::appender::FlightRecorder recorder(&m_logger, 1024);
+
+  m_logger.log(yal::Level::DEBUG, "debug");
+  m_logger.log(yal::Level::ERROR, "error");
+  const std::vector<std::string> expected{"DEBUG debug ", "ERROR error "};
+  EXPECT_EQ(appender.m_messages, expected);
+}
+
+TEST_F(FlightRecorderTest, lowestCaptureLevelOfRegisteredAppenders) {
+  {
+    yal::appender::FlightRecorder debug(&m_logger, 64, yal::Level::DEBUG);
+    EXPECT_EQ(yal::Logger::captureLevel().value(), yal::Level::DEBUG);
+    {
+      yal::appender::FlightRecorder trace(&m_logger, 64, yal::Level::TRACE);
+      EXPECT_EQ(yal::Logger::captureLevel().value(), yal::Level::TRACE);
+
+      // a recorder only receives the levels it captures
+      m_logger.log(yal::Level::TRACE, "trace");
+      EXPECT_EQ(debug.size(), 0);
+      EXPECT_NE(trace.size(), 0);
+    }
+    EXPECT_EQ(yal::Logger::captureLevel().value(), yal::Level::DEBUG);
+  }
+  EXPECT_EQ(yal::Logger::captureLevel().value(), yal::Level::OFF);
+
+  // below level messages are not passed to other appenders
+  CollectingAppender appender(&m_logger, FORMAT);
+  m_logger.log(yal::Level::DEBUG, "debug");
+  EXPECT_TRUE(appender.m_messages.empty());
+}
+
+TEST_F(FlightRecorderTest, capturedMessagesAreNotRateLimited) {
+  yal::appender::FlightRecorder recorder(&m_logger, 1024);
+  CollectingAppender appender(&m_logger, FORMAT);
+  m_logger.setRateLimit({1, 0, 0});
+
+  for (auto i = 0; i < 3; ++i) {
+    m_logger.log(yal::Level::DEBUG, "debug %", i);
+  }
+  m_logger.log(yal::Level::ERROR, "error");
+  m_logger.resetRateLimit();
+
+  const std::vector<std::string> expected{
+    "DEBUG debug 0 ", "DEBUG debug 1 ", "DEBUG debug 2 ", "ERROR error "};
+  EXPECT_EQ(appender.m_messages, expected);
+}
+
+TEST_F(FlightRecorderTest, memoryMappedSurvivesRestart) {
+  const auto path = testing::TempDir() + "yal-flight-recorder";
+  std::remove(path.c_str());
+  {
+    yal::appender::FlightRecorder recorder(
+      &m_logger, 256, path.c_str(), yal::Level::TRACE, yal::Level::OFF);
+    ASSERT_TRUE(recorder.memoryMapped());
+    m_logger.log(yal::Level::DEBUG, "before crash");
+  }
+
+  yal::appender::FlightRecorder recorder(
+    &m_logger, 256, path.c_str(), yal::Level::TRACE, yal::Level::OFF);
+  CollectingAppender appender(&m_logger, FORMAT);
+  recorder.dumpAll();
+  EXPECT_EQ(appender.m_messages, std::vector<std::string>{"DEBUG before crash "});
+  std::remove(path.c_str());
+}
+
+TEST_F(FlightRecorderTest, corruptedFileStopsReplay) {
+  const auto path = testing::TempDir() + "yal-flight-recorder-corrupted";
+  // entry offset of the level and the message length, see flightrecorder.cpp
+  constexpr const long levelOffset = 2;
+  const auto messageLengthOffset =
+    levelOffset + 1 + 4 + 1 + 1 + 1 + static_cast<long>(m_logger.context().size());
+  for (const auto corruption : {levelOffset, messageLengthOffset}) {
+    std::remove(path.c_str());
+    {
+      yal::appender::FlightRecorder recorder(
+        &m_logger, 256, path.c_str(), yal::Level::TRACE, yal::Level::OFF);
+      m_logger.log(yal::Level::DEBUG, "intact");
+      m_logger.log(yal::Level::DEBUG, "corrupted");
+      m_logger.log(yal::Level::DEBUG, "behind");
+    }
+
+    auto* const file = std::fopen(path.c_str(), "r+b");
+    ASSERT_NE(file, nullptr);
+    // the data follows the 16 byte header, the second entry follows the first
+    constexpr const long header = 16;
+    std::uint16_t firstSize = 0;
+    std::fseek(file, header, SEEK_SET);
+    ASSERT_EQ(std::fread(&firstSize, sizeof(firstSize), 1, file), 1);
+    const std::uint8_t garbage[] = {0xff, 0xff};
+    std::fseek(file, header + firstSize + corruption, SEEK_SET);
+    std::fwrite(garbage, 1, corruption == levelOffset ? 1 : sizeof(garbage), file);
+    std::fclose(file);
+
+    yal::appender::FlightRecorder recorder(
+      &m_logger, 256, path.c_str(), yal::Level::TRACE, yal::Level::OFF);
+    CollectingAppender appender(&m_logger, FORMAT);
+    recorder.dumpAll();
+    EXPECT_EQ(appender.m_messages, std::vector<std::string>{"DEBUG intact "});
+    EXPECT_EQ(recorder.size(), 0);
+  }
+  std::remove(path.c_str());
+}
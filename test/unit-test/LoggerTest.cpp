@@ -171,4 +171,76 @@ TEST_F(LoggerTest, formatCombined) {
   setFormatAndExpectLogEqual("%t FIXED % bar %m", expected);
 }
 
+TEST_F(LoggerTest, formatTrailingText) {
+  yal::Logger logger("test");
+  const TestAppender appender(&logger, "%m");
+  logger.log(yal::Level::INFO, "value % unit", 42);
+  EXPECT_EQ(appender.lastMsg(), "value 42 unit");
+}
+
+TEST_F(LoggerTest, formatFields) {
+  yal::Logger logger("test");
+  const TestAppender appender(&logger, "%m %k");
+  logger.log(
+    yal::Level::INFO,
+    {{"sensor", "temp"}, {"value", 21.5}, {"raw", -3}, {"ok", true}},
+    "reading %",
+    1);
+  EXPECT_EQ(appender.lastMsg(), "reading 1 sensor=temp value=21.5 raw=-3 ok=true");
+}
+
+TEST_F(LoggerTest, fieldsIgnoredWithoutFormatToken) {
+  yal::Logger logger("test");
+  const TestAppender appender(&logger, "%m");
+  logger.log(yal::Level::INFO, {{"sensor", "temp"}}, "reading");
+  EXPECT_EQ(appender.lastMsg(), "reading");
+}
+
+TEST_F(LoggerTest, jsonEncoding) {
+  yal::Logger logger("test");
+  TestAppender appender(&logger, "");
+  appender.setEncoding(yal::Encoding::JSON);
+  logger.log(yal::Level::INFO, {{"id", 7U}}, "say \"%\"", "hi");
+  EXPECT_EQ(
+    appender.lastMsg(),
+    R"({"time":"123456789","level":"INFO","context":"test",)"
+    R"("message":"say \"hi\"","id":7})");
+}
+
+class RecordAppender : public yal::Appender {
+ public:
+  explicit RecordAppender(yal::AppenderStorage* storage) : yal::Appender(storage, "") {
+  }
+
+  void append(const yal::LogRecord& record) override {
+    m_message = record.message;
+    m_context = record.context;
+    m_level = record.level.value();
+    m_file = record.location.file;
+    m_line = record.location.line;
+    m_fieldCount = record.fields.size();
+  }
+
+  std::string m_message;
+  std::string m_context;
+  yal::Level::Value m_level = yal::Level::OFF;
+  std::string m_file;
+  unsigned int m_line = 0;
+  std::size_t m_fieldCount = 0;
+};
+
+TEST_F(LoggerTest, recordAppender) {
+  yal::Logger logger("record");
+  RecordAppender appender(&logger);
+  // clang-format off
+  const auto line = __LINE__; logger.log(yal::Level::WARNING, {{"a", 1}}, "value %", 3);
+  // clang-format on
+  EXPECT_EQ(appender.m_message, "value 3");
+  EXPECT_EQ(appender.m_context, "record");
+  EXPECT_EQ(appender.m_level, yal::Level::WARNING);
+  EXPECT_EQ(appender.m_line, line);
+  EXPECT_NE(appender.m_file.find("LoggerTest.cpp"), std::string::npos);
+  EXPECT_EQ(appender.m_fieldCount, 1);
+}
+
 // todo write operator tests for level
@@ -0,0 +1,103 @@
+//
+// Copyright (c) 2022 Alexander Mohr
+// Licensed under the terms of the MIT License
+//
+
+#include <gtest/gtest.h>
+
+#include <yal/Metrics.hpp>
+#include <yal/appender/FlightRecorder.hpp>
+#include <yal/yal.hpp>
+#include <string>
+
+class MetricsTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    yal::Logger::setLevel(yal::Level::INFO);
+    yal::Logger::setTimeFunc([]() { return "0"; });
+    yal::Logger::resetMetrics();
+  }
+
+  void TearDown() override {
+    yal::Logger::setLevel(yal::Level::DEBUG);
+  }
+
+  class TestAppender : public yal::Appender {
+   public:
+    explicit TestAppender(yal::AppenderStorage* storage) :
+        Appender(storage, "%m") {
+    }
+
+    void append(const yal::Level& level, const char* text) override {
+    }
+  };
+};
+
+TEST_F(MetricsTest, countsPerLevel) {
+  yal::Logger logger;
+  TestAppender appender(&logger);
+  logger.log(yal::Level::DEBUG, "rejected");
+  logger.log(yal::Level::INFO, "info");
+  logger.log(yal::Level::ERROR, "error");
+  logger.log(yal::Level::ERROR, "error");
+
+  const auto& metrics = yal::Logger::metrics();
+  EXPECT_EQ(metrics.rejected.at(static_cast<int>(yal::Level::DEBUG)).load(), 1);
+  EXPECT_EQ(metrics.messages.at(static_cast<int>(yal::Level::DEBUG)).load(), 0);
+  EXPECT_EQ(metrics.messages.at(static_cast<int>(yal::Level::INFO)).load(), 1);
+  EXPECT_EQ(metrics.messages.at(static_cast<int>(yal::Level::ERROR)).load(), 2);
+  EXPECT_EQ(appender.metrics().messages.load(), 3);
+  EXPECT_EQ(appender.metrics().bytes.load(), 14);
+}
+
+TEST_F(MetricsTest, capturedAreNotDelivered) {
+  yal::Logger logger;
+  yal::appender::FlightRecorder recorder(&logger, 256, yal::Level::DEBUG);
+  TestAppender appender(&logger);
+  logger.log(yal::Level::DEBUG, "captured");
+
+  const auto& metrics = yal::Logger::metrics();
+  EXPECT_EQ(metrics.captured.at(static_cast<int>(yal::Level::DEBUG)).load(), 1);
+  EXPECT_EQ(metrics.messages.at(static_cast<int>(yal::Level::DEBUG)).load(), 0);
+  EXPECT_EQ(appender.metrics().messages.load(), 0);
+}
+
+TEST_F(MetricsTest, resetClearsAppenders) {
+  yal::Logger logger;
+  TestAppender appender(&logger);
+  logger.log(yal::Level::INFO, "info");
+  yal::Logger::resetMetrics();
+  const auto& metrics = yal::Logger::metrics();
+  EXPECT_EQ(metrics.messages.at(static_cast<int>(yal::Level::INFO)).load(), 0);
+  EXPECT_EQ(appender.metrics().messages.load(), 0);
+  EXPECT_EQ(appender.metrics().bytes.load(), 0);
+}
+
+TEST_F(MetricsTest, latencyHistogram) {
+  yal::AppenderMetrics metrics;
+  metrics.recordLatency(0);
+  metrics.recordLatency(1);
+  metrics.recordLatency(3);
+  metrics.recordLatency(1000000);
+
+  EXPECT_EQ(metrics.latencyUs.at(0).load(), 1);
+  EXPECT_EQ(metrics.latencyUs.at(1).load(), 1);
+  EXPECT_EQ(metrics.latencyUs.at(2).load(), 1);
+  EXPECT_EQ(metrics.latencyUs.back().load(), 1);
+  EXPECT_EQ(metrics.maxLatencyUs.load(), 1000000);
+  EXPECT_EQ(metrics.messages.load(), 4);
+  EXPECT_EQ(metrics.calls.load(), 4);
+}
+
+TEST_F(MetricsTest, writeJson) {
+  yal::LoggerMetrics metrics;
+  metrics.messages.at(static_cast<int>(yal::Level::INFO)).add(3);
+  metrics.rateLimited.add();
+
+  std::string json;
+  yal::Metrics::writeJson(json, metrics);
+  EXPECT_EQ(
+    json,
+    R"("messages":[0,0,3,0,0,0,0],"captured":[0,0,0,0,0,0,0],)"
+    R"("rejected":[0,0,0,0,0,0,0],"rateLimited":1)");
+}
@@ -0,0 +1,159 @@
+//
+// Copyright (c) 2022 Alexander Mohr
+// Licensed under the terms of the MIT License
+//
+
+#include <gtest/gtest.h>
+
+#include <CollectingAppender.hpp>
+#include <yal/RateLimiter.hpp>
+#include <yal/yal.hpp>
+#include <string>
+#include <vector>
+
+class RateLimiterTest : public testing::Test {
+ protected:
+  static constexpr const char* m_site = "site %";
+  static constexpr const char* m_context = "context";
+
+  yal::RateLimiter::Result check(
+    const char* site,
+    const yal::RateLimit& limit,
+    const unsigned long now) {
+    return m_limiter.check(site, m_context, yal::Level::INFO, limit, now);
+  }
+
+  yal::RateLimiter m_limiter;
+};
+
+TEST_F(RateLimiterTest, tokenBucket) {
+  const yal::RateLimit limit{2, 10, 0};
+  EXPECT_TRUE(check(m_site, limit, 0).allowed);
+  EXPECT_TRUE(check(m_site, limit, 0).allowed);
+  EXPECT_FALSE(check(m_site, limit, 0).allowed);
+  EXPECT_FALSE(check(m_site, limit, 50).allowed);
+
+  // 10 tokens per second refill one token every 100ms
+  const auto result = check(m_site, limit, 100);
+  EXPECT_TRUE(result.allowed);
+  EXPECT_EQ(result.suppressed, 2);
+}
+
+TEST_F(RateLimiterTest, levelIsPartOfCallSite) {
+  const yal::RateLimit limit{1, 0, 0};
+  EXPECT_TRUE(check(m_site, limit, 0).allowed);
+  EXPECT_FALSE(check(m_site, limit, 0).allowed);
+  EXPECT_TRUE(m_limiter.check(m_site, m_context, yal::Level::ERROR, limit, 0).allowed);
+}
+
+TEST_F(RateLimiterTest, contextIsPartOfCallSite) {
+  const yal::RateLimit limit{1, 0, 0};
+  EXPECT_TRUE(m_limiter.check(m_site, "first", yal::Level::INFO, limit, 0).allowed);
+  EXPECT_FALSE(m_limiter.check(m_site, "first", yal::Level::INFO, limit, 0).allowed);
+  EXPECT_TRUE(m_limiter.check(m_site, "second", yal::Level::INFO, limit, 0).allowed);
+}
+
+TEST_F(RateLimiterTest, duplicateWindow) {
+  const yal::RateLimit limit{0, 0, 1000};
+  EXPECT_TRUE(check(m_site, limit, 0).allowed);
+  for (auto i = 1U; i < 5; ++i) {
+    const auto result = check(m_site, limit, i * 100);
+    EXPECT_FALSE(result.allowed);
+    EXPECT_EQ(result.suppressed, i);
+  }
+
+  const auto result = check(m_site, limit, 1000);
+  EXPECT_TRUE(result.allowed);
+  EXPECT_EQ(result.suppressed, 4);
+}
+
+TEST_F(RateLimiterTest, summariesOfExpiredWindows) {
+  const yal::RateLimit limit{0, 0, 1000};
+  static constexpr const char* other = "other";
+  EXPECT_TRUE(check(m_site, limit, 0).allowed);
+  EXPECT_FALSE(check(m_site, limit, 100).allowed);
+  EXPECT_FALSE(check(m_site, limit, 200).allowed);
+  EXPECT_FALSE(check(other, limit, 500).summariesDue);
+  EXPECT_TRUE(check(other, limit, 1000).summariesDue);
+
+  std::vector<yal::RateLimiter::Summary> summaries;
+  m_limiter.takeSummaries(summaries, 1000, false);
+  ASSERT_EQ(summaries.size(), 1);
+  EXPECT_EQ(summaries.front().context, m_context);
+  EXPECT_EQ(summaries.front().level.value(), yal::Level::INFO);
+  EXPECT_EQ(summaries.front().suppressed, 2);
+
+  // the suppressed messages are only reported once
+  summaries.clear();
+  m_limiter.takeSummaries(summaries, 2000, true);
+  EXPECT_EQ(summaries.size(), 1);
+  EXPECT_EQ(summaries.front().suppressed, 1);
+  const auto result = check(m_site, limit, 2000);
+  EXPECT_TRUE(result.allowed);
+  EXPECT_EQ(result.suppressed, 0);
+}
+
+TEST_F(RateLimiterTest, summaryContextIsTruncated) {
+  const yal::RateLimit limit{0, 0, 1000};
+  const std::string context(YAL_RATE_LIMIT_CONTEXT_SIZE + 8, 'c');
+  EXPECT_TRUE(m_limiter.check(m_site, context, yal::Level::INFO, limit, 0).allowed);
+  EXPECT_FALSE(m_limiter.check(m_site, context, yal::Level::INFO, limit, 1).allowed);
+
+  std::vector<yal::RateLimiter::Summary> summaries;
+  m_limiter.takeSummaries(summaries, 1, true);
+  ASSERT_EQ(summaries.size(), 1);
+  EXPECT_EQ(summaries.front().context, context.substr(0, YAL_RATE_LIMIT_CONTEXT_SIZE));
+}
+
+TEST_F(RateLimiterTest, tableIsAllocatedOnUse) {
+  // the table of call sites is not part of the static storage of the logger
+  EXPECT_LT(sizeof(yal::RateLimiter), 128);
+}
+
+TEST_F(RateLimiterTest, tableFullNeverLimits) {
+  const yal::RateLimit limit{1, 0, 0};
+  std::vector<char> sites(YAL_RATE_LIMIT_SITES + 1);
+  for (auto& site : sites) {
+    EXPECT_TRUE(check(&site, limit, 0).allowed);
+  }
+  EXPECT_TRUE(check(&sites.back(), limit, 0).allowed);
+}
+
+TEST_F(RateLimiterTest, loggerLimits) {
+  yal::Logger::setLevel(yal::Level::TRACE);
+  yal::Logger limited("limited");
+  yal::Logger unlimited("unlimited");
+  CollectingAppender appender(&limited);
+
+  yal::Logger::setGlobalRateLimit({1, 0, 0});
+  unlimited.setRateLimit({});
+  for (auto i = 0; i < 3; ++i) {
+    limited.log(yal::Level::INFO, "flapping %", i);
+    unlimited.log(yal::Level::INFO, "unlimited %", i);
+  }
+  // pending summaries are reported before the limit changes
+  yal::Logger::setGlobalRateLimit({});
+
+  const std::vector<std::string> expected{
+    "flapping 0",
+    "unlimited 0",
+    "unlimited 1",
+    "unlimited 2",
+    "last message repeated 2 times"};
+  EXPECT_EQ(appender.m_messages, expected);
+}
+
+TEST_F(RateLimiterTest, flushReportsSummaries) {
+  yal::Logger::setLevel(yal::Level::TRACE);
+  yal::Logger logger("flushed");
+  CollectingAppender appender(&logger);
+
+  logger.setRateLimit({0, 0, 60000});
+  for (auto i = 0; i < 3; ++i) {
+    logger.log(yal::Level::INFO, "repeated");
+  }
+  yal::Logger::flush();
+
+  const std::vector<std::string> expected{"repeated", "last message repeated 2 times"};
+  EXPECT_EQ(appender.m_messages, expected);
+}
@@ -0,0 +1,59 @@
+//
+// Copyright (c) 2022 Alexander Mohr
+// Licensed under the terms of the MIT License
+//
+
+#include <gtest/gtest.h>
+
+#include <CollectingAppender.hpp>
+#include <yal/Sampler.hpp>
+#include <yal/yal.hpp>
+#include <string>
+#include <vector>
+
+template<typename S>
+std::vector<std::uint32_t> sampledOccurrences(S& sampler, std::uint32_t count) {
+  std::vector<std::uint32_t> sampled;
+  for (auto i = 1U; i <= count; ++i) {
+    if (sampler.sample()) {
+      sampled.push_back(i);
+    }
+  }
+  return sampled;
+}
+
+TEST(SamplerTest, everyN) {
+  yal::EveryN sampler(3);
+  EXPECT_EQ(sampledOccurrences(sampler, 10), (std::vector<std::uint32_t>{1, 4, 7, 10}));
+}
+
+TEST(SamplerTest, firstNThenBackoff) {
+  yal::FirstNThenBackoff sampler(2);
+  EXPECT_EQ(
+    sampledOccurrences(sampler, 20), (std::vector<std::uint32_t>{1, 2, 4, 8, 16}));
+}
+
+TEST(SamplerTest, probability) {
+  yal::Probability never(0);
+  yal::Probability always(1);
+  yal::Probability half(0.5);
+  EXPECT_TRUE(sampledOccurrences(never, 100).empty());
+  EXPECT_EQ(sampledOccurrences(always, 100).size(), 100);
+
+  const auto sampled = sampledOccurrences(half, 10000).size();
+  EXPECT_GT(sampled, 4500);
+  EXPECT_LT(sampled, 5500);
+}
+
+TEST(SamplerTest, logger) {
+  yal::Logger::setLevel(yal::Level::TRACE);
+  yal::Logger logger("sampled");
+  CollectingAppender appender(&logger);
+  for (auto i = 0; i < 5; ++i) {
+    static yal::EveryN everySecond(2);
+    logger.log(everySecond, yal::Level::DEBUG, "loop %", i);
+  }
+
+  const std::vector<std::string> expected{"loop 0", "loop 2", "loop 4"};
+  EXPECT_EQ(appender.m_messages, expected);
+}
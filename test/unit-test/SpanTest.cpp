@@ -0,0 +1,104 @@
+//
+// Copyright (c) 2022 Alexander Mohr
+// Licensed under the terms of the MIT License
+//
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <yal/Span.hpp>
+#include <yal/yal.hpp>
+#include <string>
+#include <thread>
+
+class SpanTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    yal::Tracer::setEnabled(true);
+    std::string discard;
+    yal::Tracer::drain(discard);
+  }
+
+  void TearDown() override {
+    yal::Tracer::setEnabled(true);
+  }
+
+  static std::string trace() {
+    std::string json;
+    yal::Tracer::writeChromeTrace(json);
+    return json;
+  }
+};
+
+TEST_F(SpanTest, nestedSpans) {
+  yal::Logger logger("net");
+  {
+    yal::Span outer(logger, "outer");
+    yal::Span inner(logger, "inner");
+  }
+
+  // spans are recorded when they end, so the inner one comes first
+  const auto json = trace();
+  EXPECT_THAT(
+    json,
+    testing::MatchesRegex(
+      R"(\{"traceEvents":\[)"
+      R"(\{"name":"inner","cat":"net","ph":"X",)"
+      R"("ts":[0-9]+\.[0-9]{3},"dur":[0-9]+\.[0-9]{3},)"
+      R"("pid":1,"tid":[0-9]+,"args":\{"depth":1\}\},)"
+      R"(\{"name":"outer","cat":"net","ph":"X",.*"args":\{"depth":0\}\}\]\})"));
+  EXPECT_EQ(trace(), R"({"traceEvents":[]})");
+}
+
+TEST_F(SpanTest, disabled) {
+  yal::Logger logger;
+  yal::Tracer::setEnabled(false);
+  {
+    yal::Span span(logger, "span");
+  }
+  EXPECT_EQ(trace(), R"({"traceEvents":[]})");
+}
+
+TEST_F(SpanTest, chromeTraceFromBinary) {
+  yal::Tracer::record(1234567, 1236567, 2, "loop", "main");
+  std::string binary;
+  yal::Tracer::drain(binary);
+
+  std::string json;
+  EXPECT_TRUE(yal::Tracer::writeChromeTrace(json, binary));
+  EXPECT_THAT(
+    json,
+    testing::MatchesRegex(
+      R"(\{"traceEvents":\[\{"name":"loop","cat":"main","ph":"X","ts":1234\.567,)"
+      R"("dur":2\.000,"pid":1,"tid":[0-9]+,"args":\{"depth":2\}\}\]\})"));
+
+  json.clear();
+  EXPECT_FALSE(yal::Tracer::writeChromeTrace(json, binary.substr(0, binary.size() - 1)));
+  EXPECT_EQ(json, R"({"traceEvents":[]})");
+}
+
+TEST_F(SpanTest, threadsHaveOwnBuffers) {
+  yal::Logger logger;
+  std::thread([&logger]() { yal::Span span(logger, "worker"); }).join();
+  {
+    yal::Span span(logger, "main");
+  }
+
+  const auto json = trace();
+  EXPECT_THAT(json, testing::HasSubstr(R"("name":"worker")"));
+  EXPECT_THAT(json, testing::HasSubstr(R"("name":"main")"));
+  const auto firstTid = json.find("\"tid\":");
+  const auto secondTid = json.find("\"tid\":", firstTid + 1);
+  ASSERT_NE(secondTid, std::string::npos);
+  EXPECT_NE(json.substr(firstTid, 8), json.substr(secondTid, 8));
+}
+
+TEST_F(SpanTest, dropWhenFull) {
+  const auto dropped = yal::Tracer::dropped();
+  // 19 bytes fixed size per span
+  const std::string name(200, 'x');
+  for (auto i = 0; i < YAL_TRACE_BUFFER_SIZE / 219 + 2; ++i) {
+    yal::Tracer::record(0, 1, 0, name, "");
+  }
+  EXPECT_EQ(yal::Tracer::dropped(), dropped + 2);
+}
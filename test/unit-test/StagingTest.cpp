@@ -0,0 +1,330 @@
+//
+// Copyright (c) 2022 Alexander Mohr
+// Licensed under the terms of the MIT License
+//
+
+#include <gtest/gtest.h>
+
+#include <yal/appender/FlightRecorder.hpp>
+#include <yal/yal.hpp>
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+class StagingTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    yal::Logger::setLevel(yal::Level::DEBUG);
+    yal::Logger::setStaging(0);
+  }
+
+  void TearDown() override {
+    yal::Logger::setStaging(0);
+  }
+
+  struct Message {
+    std::uint64_t sequence;
+    std::string text;
+  };
+
+  class BatchAppender : public yal::Appender {
+   public:
+    explicit BatchAppender(yal::AppenderStorage* storage) : Appender(storage, "%m") {
+    }
+
+    void appendBatch(const yal::LogBatch& batch) override {
+      batchSizes.push_back(batch.size());
+      Appender::appendBatch(batch);
+    }
+
+    void append(const yal::LogRecord& record) override {
+      ++direct;
+      Appender::append(record);
+    }
+
+    void append(const yal::Level& level, const char* text) override {
+      messages.push_back(text);
+    }
+
+    std::vector<std::size_t> batchSizes;
+    std::vector<std::string> messages;
+    std::size_t direct = 0;
+  };
+
+  class SequenceAppender : public yal::Appender {
+   public:
+    explicit SequenceAppender(yal::AppenderStorage* storage) : Appender(storage, "%m") {
+    }
+
+    void appendBatch(const yal::LogBatch& batch) override {
+      for (const auto& entry : batch) {
+        messages.push_back({entry.sequence, std::string(entry.data)});
+      }
+    }
+
+    std::vector<Message> messages;
+  };
+};
+
+TEST_F(StagingTest, deliveredOnFlush) {
+  yal::Logger logger;
+  BatchAppender appender(&logger);
+  yal::Logger::setStaging(1024);
+
+  logger.log(yal::Level::INFO, "first");
+  logger.log(yal::Level::INFO, "second %", 2);
+  EXPECT_TRUE(appender.messages.empty());
+
+  yal::Logger::flush();
+  EXPECT_EQ(appender.messages, (std::vector<std::string>{"first", "second 2"}));
+  EXPECT_EQ(appender.batchSizes, std::vector<std::size_t>{2});
+  EXPECT_EQ(appender.direct, 0);
+}
+
+TEST_F(StagingTest, fullBatchIsHandedOff) {
+  yal::Logger logger;
+  BatchAppender appender(&logger);
+  // header, message and null byte exceed the batch size after two messages
+  yal::Logger::setStaging(yal::LogBatch::HEADER_SIZE * 2);
+
+  logger.log(yal::Level::INFO, "a");
+  EXPECT_TRUE(appender.messages.empty());
+  logger.log(yal::Level::INFO, "b");
+  EXPECT_EQ(appender.messages, (std::vector<std::string>{"a", "b"}));
+}
+
+TEST_F(StagingTest, disablingFlushes) {
+  yal::Logger logger;
+  BatchAppender appender(&logger);
+  yal::Logger::setStaging(1024);
+  logger.log(yal::Level::INFO, "staged");
+  yal::Logger::setStaging(0);
+  logger.log(yal::Level::INFO, "direct");
+  EXPECT_EQ(appender.messages, (std::vector<std::string>{"staged", "direct"}));
+  EXPECT_EQ(appender.direct, 1);
+}
+
+TEST_F(StagingTest, errorIsHandedOffImmediately) {
+  yal::Logger logger;
+  BatchAppender appender(&logger);
+  yal::Logger::setStaging(1024);
+
+  logger.log(yal::Level::WARNING, "warning");
+  EXPECT_TRUE(appender.messages.empty());
+  logger.log(yal::Level::ERROR, "error");
+  EXPECT_EQ(appender.messages, (std::vector<std::string>{"warning", "error"}));
+
+  yal::Logger::setStaging(1024, yal::Level::FATAL);
+  logger.log(yal::Level::ERROR, "staged");
+  EXPECT_EQ(appender.messages.size(), 2);
+  logger.log(yal::Level::FATAL, "fatal");
+  EXPECT_EQ(appender.messages.size(), 4);
+}
+
+TEST_F(StagingTest, metricsCountMessagesOfBatch) {
+  yal::Logger logger;
+  BatchAppender appender(&logger);
+  yal::Logger::setStaging(1024);
+
+  logger.log(yal::Level::INFO, "first");
+  logger.log(yal::Level::INFO, "second");
+  logger.log(yal::Level::INFO, "third");
+  yal::Logger::flush();
+  EXPECT_EQ(appender.metrics().messages.load(), 3);
+  EXPECT_EQ(appender.metrics().calls.load(), 1);
+}
+
+TEST_F(StagingTest, removedAppenderIsDiscarded) {
+  yal::Logger logger;
+  BatchAppender other(&logger);
+  {
+    BatchAppender appender(&logger);
+    yal::Logger::setStaging(1024);
+    logger.log(yal::Level::INFO, "message");
+  }
+  yal::Logger::flush();
+  EXPECT_EQ(other.messages, std::vector<std::string>{"message"});
+}
+
+TEST_F(StagingTest, threadOrderAndSequence) {
+  static constexpr const auto threadCount = 4;
+  static constexpr const auto messageCount = 500;
+  yal::Logger logger;
+  SequenceAppender appender(&logger);
+  yal::Logger::setStaging(256);
+
+  std::vector<std::thread> threads;
+  for (auto t = 0; t < threadCount; ++t) {
+    threads.emplace_back([&logger, t]() {
+      for (auto i = 0; i < messageCount; ++i) {
+        logger.log(yal::Level::INFO, "% %", t, i);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  yal::Logger::flush();
+
+  ASSERT_EQ(appender.messages.size(), threadCount * messageCount);
+  std::map<std::uint64_t, std::string> bySequence;
+  std::map<std::string, std::pair<int, std::uint64_t>> lastOfThread;
+  for (const auto& message : appender.messages) {
+    EXPECT_TRUE(bySequence.insert({message.sequence, message.text}).second);
+
+    const auto separator = message.text.find(' ');
+    const auto thread = message.text.substr(0, separator);
+    const auto index = std::stoi(message.text.substr(separator + 1));
+    const auto last = lastOfThread.find(thread);
+    if (last != lastOfThread.end()) {
+      EXPECT_EQ(index, last->second.first + 1);
+      EXPECT_GT(message.sequence, last->second.second);
+    }
+    lastOfThread[thread] = {index, message.sequence};
+  }
+  EXPECT_EQ(lastOfThread.size(), threadCount);
+}
+
+TEST_F(StagingTest, threadExitsDuringFlush) {
+  // blocks the flush while it hands off the message "block"
+  class GatedAppender : public yal::Appender {
+   public:
+    explicit GatedAppender(yal::AppenderStorage* storage) : Appender(storage, "%m") {
+    }
+
+    void appendBatch(const yal::LogBatch& batch) override {
+      for (const auto& entry : batch) {
+        if (entry.data == "block") {
+          blocked.set_value();
+          release.get_future().wait();
+        }
+        messages.emplace_back(entry.data);
+      }
+    }
+
+    std::promise<void> blocked;
+    std::promise<void> release;
+    std::vector<std::string> messages;
+  };
+
+  yal::Logger logger;
+  GatedAppender appender(&logger);
+  yal::Logger::setStaging(1024);
+
+  std::promise<void> logAgain;
+  std::promise<void> staged;
+  std::thread first([&]() {
+    logger.log(yal::Level::INFO, "before flush");
+    staged.set_value();
+    logAgain.get_future().wait();
+    logger.log(yal::Level::INFO, "after hand off");
+  });
+  staged.get_future().wait();
+  // staged behind the first thread, so its stage is handed off later
+  std::thread([&logger]() { logger.log(yal::Level::INFO, "block"); }).join();
+
+  std::thread flusher([]() { yal::Logger::flush(); });
+  appender.blocked.get_future().wait();
+  // the first stage has been handed off, log into it and end the thread
+  logAgain.set_value();
+  first.join();
+  appender.release.set_value();
+  flusher.join();
+
+  yal::Logger::flush();
+  EXPECT_EQ(
+    appender.messages,
+    (std::vector<std::string>{"before flush", "block", "after hand off"}));
+}
+
+TEST_F(StagingTest, forwardedHistoryIsStaged) {
+  yal::Logger logger;
+  SequenceAppender appender(&logger);
+  yal::appender::FlightRecorder recorder(&logger, 1024);
+  yal::Logger::setLevel(yal::Level::INFO);
+  yal::Logger::setStaging(1024);
+
+  logger.log(yal::Level::INFO, "before");
+  logger.log(yal::Level::DEBUG, "history");
+  logger.log(yal::Level::ERROR, "error");
+
+  ASSERT_EQ(appender.messages.size(), 3);
+  EXPECT_EQ(appender.messages[0].text, "before");
+  EXPECT_EQ(appender.messages[1].text, "history");
+  EXPECT_EQ(appender.messages[2].text, "error");
+  EXPECT_NE(appender.messages[0].sequence, 0);
+  EXPECT_LT(appender.messages[0].sequence, appender.messages[1].sequence);
+  EXPECT_LT(appender.messages[1].sequence, appender.messages[2].sequence);
+}
+
+TEST_F(StagingTest, directAppendersAreSerialized) {
+  class RecordAppender : public yal::Appender {
+   public:
+    explicit RecordAppender(yal::AppenderStorage* storage) : Appender(storage, "%m") {
+    }
+
+    void append(const yal::LogRecord& record) override {
+      const auto concurrent = ++m_active;
+      if (concurrent > maxConcurrent) {
+        maxConcurrent = concurrent;
+      }
+      std::this_thread::yield();
+      --m_active;
+    }
+
+    [[nodiscard]] bool supportsStaging() const override {
+      return false;
+    }
+
+    int maxConcurrent = 0;
+
+   private:
+    std::atomic<int> m_active{0};
+  };
+
+  yal::Logger logger;
+  RecordAppender appender(&logger);
+  yal::Logger::setStaging(1024);
+  std::vector<std::thread> threads;
+  for (auto i = 0; i < 4; ++i) {
+    threads.emplace_back([&logger]() {
+      for (auto j = 0; j < 1000; ++j) {
+        logger.log(yal::Level::INFO, "message");
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(appender.maxConcurrent, 1);
+}
+
+TEST_F(StagingTest, nestedLoggingIsNotStaged) {
+  class LoggingAppender : public yal::Appender {
+   public:
+    LoggingAppender(yal::Logger& logger) : Appender(&logger, "%m"), m_logger(logger) {
+    }
+
+    void appendBatch(const yal::LogBatch& batch) override {
+      m_logger.log(yal::Level::INFO, "nested");
+    }
+
+   private:
+    yal::Logger& m_logger;
+  };
+
+  yal::Logger logger;
+  BatchAppender appender(&logger);
+  LoggingAppender loggingAppender(logger);
+  yal::Logger::setStaging(1024);
+  logger.log(yal::Level::INFO, "message");
+  yal::Logger::flush();
+  yal::Logger::flush();
+
+  EXPECT_EQ(appender.direct, 1);
+  EXPECT_EQ(appender.messages, (std::vector<std::string>{"message", "nested"}));
+}